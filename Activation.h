@@ -0,0 +1,169 @@
+#ifndef ACTIVATION_H_INCLUDED
+#define ACTIVATION_H_INCLUDED
+
+#include <math.h>
+
+#include "EActivationFunction.h"
+#include "FastMath.h"
+
+/**
+    Activation functions as compile time policies.
+    Activation<F>::apply and ::derivative evaluate one value, the array
+    overload of apply evaluates a whole array in place. Since F is known at
+    compile time a loop calling them contains no switch and can be inlined
+    and, for the arithmetic functions, vectorised.
+
+    Approximate = true swaps the libm calls of LOGISTIC, TANH, TANH01,
+    ARCTAN, ARCTAN01 and GAUSSIAN for the FastMath.h approximations, see
+    there for their maximum errors. The other functions are exact either way.
+*/
+template <EActivationFunction F, bool Approximate = false>
+struct Activation
+{
+    static constexpr EActivationFunction function = F;
+
+    // Whether Approximate changes anything for this function
+    static constexpr bool approximated = F == LOGISTIC || F == TANH || F == TANH01 || F == ARCTAN || F == ARCTAN01 || F == GAUSSIAN;
+
+    FAST_MATH_INLINE static float exp(float input) {return Approximate ? fastExp(input) : expf(input);}
+    FAST_MATH_INLINE static float tanh(float input) {return Approximate ? fastTanh(input) : tanhf(input);}
+    FAST_MATH_INLINE static float atan(float input) {return Approximate ? fastAtan(input) : atanf(input);}
+
+    FAST_MATH_INLINE static float apply(float input)
+    {
+        if constexpr (F == LINEAR)
+            return input;
+        else if constexpr (F == HEAVISIDE) // 0 to 1
+            return fastSelect(input > 0, 1.0f, fastSelect(input == 0, 0.5f, 0.0f));
+        else if constexpr (F == LOGISTIC) // From 0 to 1
+            return 1.0f / (1.0f + exp(-input));
+        else if constexpr (F == SOFTMAX)
+            return 0;
+        else if constexpr (F == TANH) // From -1 to 1
+            return tanh(input);
+        else if constexpr (F == TANH01) // From 0 to 1
+            return tanh(input) / 2.0f + 0.5f;
+        else if constexpr (F == RECTIFIED_LINEAR_UNIT)
+            return fastSelect(input < 0, 0.0f, input);
+        else if constexpr (F == ARCTAN) // From -pi/2 to pi/2
+            return atan(input);
+        else if constexpr (F == ARCTAN01) // From 0 to 1
+            return atan(input) / 3.14159265358979f + 0.5f;
+        else if constexpr (F == SYMMETRICAL_HARD_LIMIT) // -1 to 1
+            return fastSelect(input > 0, 1.0f, fastSelect(input == 0, 0.0f, -1.0f));
+        else if constexpr (F == SINUSOID) // -1 to 1
+            return sinf(input);
+        else if constexpr (F == SINUSOID01) // 0 to 1
+            return sinf(input) / 2.0f + 0.5f;
+        else if constexpr (F == GAUSSIAN) // 0 to 1
+            return exp(-input * input);
+        else
+            return input; // Assume linear otherwise
+    }
+
+    FAST_MATH_INLINE static float derivative(float input)
+    {
+        if constexpr (F == LINEAR)
+            return 1;
+        else if constexpr (F == HEAVISIDE)
+            return 0; // Will not work with back propagation
+        else if constexpr (F == LOGISTIC)
+        {
+            float value = apply(input);
+            return value * (1.0f - value);
+        }
+        else if constexpr (F == SOFTMAX)
+            return 0;
+        else if constexpr (F == TANH)
+        {
+            float value = tanh(input);
+            return 1.0f - value * value;
+        }
+        else if constexpr (F == TANH01)
+        {
+            float value = tanh(input);
+            return (1.0f - value * value) / 2.0f;
+        }
+        else if constexpr (F == RECTIFIED_LINEAR_UNIT)
+            return fastSelect(input < 0, 0.0f, 1.0f);
+        else if constexpr (F == ARCTAN)
+            return 1.0f / (input * input + 1.0f);
+        else if constexpr (F == ARCTAN01)
+            return 1.0f / (input * input + 1.0f) / 3.14159265358979f;
+        else if constexpr (F == SYMMETRICAL_HARD_LIMIT)
+            return 0;
+        else if constexpr (F == SINUSOID)
+            return cosf(input);
+        else if constexpr (F == SINUSOID01)
+            return cosf(input) / 2.0f;
+        else if constexpr (F == GAUSSIAN)
+            return -2 * input * exp(-input * input);
+        else
+            return 1; // Assume linear otherwise
+    }
+
+    /**
+    Array at a time variant, applies the function to every value in place
+    */
+    static void apply(float* values, long long count)
+    {
+        if constexpr (F == LINEAR || F == NOT_SPECIFIED)
+            return;
+        for (long long i = 0; i < count; i++)
+            values[i] = apply(values[i]);
+    }
+
+    /**
+    Array at a time derivative, output may be the same array as input
+    */
+    static void derivative(const float* input, float* output, long long count)
+    {
+        for (long long i = 0; i < count; i++)
+            output[i] = derivative(input[i]);
+    }
+};
+
+// Approximated variant of F when asked for and there is one, see dispatchActivation
+template <EActivationFunction F, class Body>
+inline void dispatchApproximation(bool approximate, Body &&body)
+{
+    if constexpr (Activation<F>::approximated)
+        if (approximate)
+        {
+            body(Activation<F, true>());
+            return;
+        }
+    body(Activation<F, false>());
+}
+
+/**
+    Runs body(Activation<F, approximate>()) with the policy matching the
+    runtime values, so that the switch happens once per call and body, a
+    generic lambda, is instantiated once per activation function.
+    Learning and prediction pass their whole loop over the samples as
+    body, so the activation function is inlined into the loop rather than
+    resolved for every sample.
+*/
+template <class Body>
+inline void dispatchActivation(EActivationFunction function, bool approximate, Body &&body)
+{
+    switch (function)
+    {
+        case LINEAR: dispatchApproximation<LINEAR>(approximate, body); return;
+        case HEAVISIDE: dispatchApproximation<HEAVISIDE>(approximate, body); return;
+        case LOGISTIC: dispatchApproximation<LOGISTIC>(approximate, body); return;
+        case SOFTMAX: dispatchApproximation<SOFTMAX>(approximate, body); return;
+        case TANH: dispatchApproximation<TANH>(approximate, body); return;
+        case TANH01: dispatchApproximation<TANH01>(approximate, body); return;
+        case RECTIFIED_LINEAR_UNIT: dispatchApproximation<RECTIFIED_LINEAR_UNIT>(approximate, body); return;
+        case ARCTAN: dispatchApproximation<ARCTAN>(approximate, body); return;
+        case ARCTAN01: dispatchApproximation<ARCTAN01>(approximate, body); return;
+        case SYMMETRICAL_HARD_LIMIT: dispatchApproximation<SYMMETRICAL_HARD_LIMIT>(approximate, body); return;
+        case SINUSOID: dispatchApproximation<SINUSOID>(approximate, body); return;
+        case SINUSOID01: dispatchApproximation<SINUSOID01>(approximate, body); return;
+        case GAUSSIAN: dispatchApproximation<GAUSSIAN>(approximate, body); return;
+        default: dispatchApproximation<LINEAR>(approximate, body); return; // Assume linear otherwise
+    }
+}
+
+#endif // ACTIVATION_H_INCLUDED
@@ -3,44 +3,103 @@
 
 #include <string>
 #include <memory>
-
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <string.h>
+
+#include "BinaryFile.h"
+#include "Storage.h"
+
+/**
+    Dynamic array with shared storage.
+
+    The storage can hold more elements than the array uses (its capacity)
+    and grows geometrically, so push_back is amortised O(1) and insert and
+    remove shift the elements in place.
+    Like Matrix, a copy constructed array shares the storage while an
+    assigned one gets a copy of the elements. Shared storage, or storage
+    not owned at all (a mapped file), is never resized or shifted:
+    setSize, reserve, push_back, insert and remove first move the array to
+    storage of its own. Element writes through operator [] and getArray do
+    not, they are seen by every array sharing the storage.
+*/
 template <class T>
 class Array
 {
     int arraySize = 0;
+    int arrayCapacity = 0; // 0 when the storage is not owned by the array
     std::shared_ptr<T[]> object;
 
     public:
         Array(){};
-        Array(int size){arraySize = size; object.reset(new T[arraySize]);};
+        Array(int size){arraySize = size; arrayCapacity = size; object = allocateStorage<T>(arraySize);};
+        Array(const Array<T> &array) = default; // Shares the storage
+
+        /**
+            Maps a binary file written by save read-only, same as the
+            Matrix path constructor
+        */
+        explicit Array(const std::string &path)
+        {
+            uint64_t sizeX, sizeY;
+            uint32_t layout; // A vector reads the same in either layout
+            std::shared_ptr<void> elements = mapBinaryFile(path, BinaryDataType<T>::value, sizeof(T), sizeX, sizeY, layout);
+            if (sizeY != 1 || sizeX > INT_MAX)
+                throw std::runtime_error("Array: " + path + " does not hold a single vector");
+            object = std::shared_ptr<T[]>(elements, (T*) elements.get());
+            arraySize = (int) sizeX;
+            arrayCapacity = 0;
+        }
         ~Array(){};
 
-        int size(){return arraySize;}
+        int size() const {return arraySize;}
+        int capacity() const {return arrayCapacity;}
         T* getArray(){return object.get();};
+        const T* getArray() const {return object.get();}
+        void save(const std::string &path) const {writeBinaryFile(path, BinaryDataType<T>::value, sizeof(T), arraySize, 1, object.get());}
+
         void setSize(int size)
         {
-            // Create a new object array
-            T* newObject = new T[size];
-
-            // Copy over the old contents to the new one
-            for (int i = 0; i < size && i < arraySize; i++)
-                newObject[i] = object[i];
-
-            // Set the new object array reference
-            object.reset(newObject);
+            // Storage of its own, large enough, is simply reused
+            if (!ownsStorage() || size > arrayCapacity)
+                reallocate(size);
 
             // Update the size
             arraySize = size;
         }
 
+        /**
+            Makes room for at least newCapacity elements without changing the size
+        */
+        void reserve(int newCapacity)
+        {
+            if (!ownsStorage() || newCapacity > arrayCapacity)
+                reallocate(newCapacity > arraySize ? newCapacity : arraySize);
+        }
+
+        /**
+            Appends the value, amortised O(1)
+        */
+        void push_back(const T &value)
+        {
+            if (!ownsStorage() || arraySize == arrayCapacity)
+            {
+                T copy = value; // The value may be an element of this array
+                reallocate(grownCapacity(arraySize + 1));
+                object[arraySize++] = std::move(copy);
+            }
+            else
+                object[arraySize++] = value;
+        }
+
         /**
             Inserts the target data at the specified index
             [FRONTDATA, VALUE, ENDDATA]
 
-            Memmove not used because it prevents insert operation
-            applied to the same array
-
-            @warning Unstable
+            The end data is shifted in place when the capacity allows,
+            otherwise the array is copied into grown storage once
         */
         void insert(T value, int index)
         {
@@ -48,23 +107,14 @@ class Array
 //            if (index >= arraySize + 1)
 //                exit(1);
 
-            // 1) Create a new object array of new size
-            T* newObject = new T[arraySize + 1];
+            // 1) Make room for one more element
+            if (!ownsStorage() || arraySize == arrayCapacity)
+                reallocate(grownCapacity(arraySize + 1), index, 1);
+            else
+                moveElements(&object[index], &object[index + 1], arraySize - index);
 
-            // 2) Memcpy/Memmove front half to new array
-            // memmove(&newObject[0], &object[0], index * sizeof(T));
-            memcpy(&newObject[0], &object[0], index * sizeof(T));
-
-            // 3) Set the data at the new index position
-            // memmove(&newObject[index], &value, sizeof(T));
-            newObject[index] = value;
-
-            // 4) Memcpy/Memmove end half to new array
-            // memmove(&newObject[index + 1], &object[index], (arraySize - index) * sizeof(T));
-            memcpy(&newObject[index + 1], &object[index], (arraySize - index) * sizeof(T));
-
-            // 5) Update the object and size
-            object.reset(newObject);
+            // 2) Set the data at the new index position and update the size
+            object[index] = std::move(value);
             arraySize++;
         }
 
@@ -72,10 +122,7 @@ class Array
             Inserts the target array data at the specified index
             [FRONTDATA, NEWARRAYDATA, ENDDATA]
 
-            Memmove not used because it prevents insert operation
-            applied to the same array
-
-            @warning Unstable
+            The array may be this array itself
         */
         void insert(Array<T> &array, int index)
         {
@@ -83,79 +130,77 @@ class Array
 //            if (index >= arraySize + array.size())
 //                return;
 
-            // 1) Create a new object array of new size
-            T* newObject = new T[arraySize + array.size()];
-
-            // 2) Memcpy/Memmove front half to new array
-            // memmove(&newObject[0], &object[0], index * sizeof(T));
-            memcpy(&newObject[0], &object[0], index * sizeof(T));
-
-            // 3) Memcpy/Memmove new array data to new array
-            // memmove(&newObject[index], &array[0], array.size() * sizeof(T));
-            memcpy(&newObject[index], &array[0], array.size() * sizeof(T));
-
-            // 4) Memcpy/Memmove end half to new array
-            // memmove(&newObject[index + array.size()], &object[index], (arraySize - index) * sizeof(T));
-            memcpy(&newObject[index + array.size()], &object[index], (arraySize - index) * sizeof(T));
-
-            // 5) Update the object and size
-            object.reset(newObject);
-            arraySize = arraySize + array.size();
+            int count = array.size();
+
+            // 1) Make room for the new array data, growing into new storage
+            // whenever the inserted data lives in the current one
+            bool sameStorage = array.object == object;
+            if (!ownsStorage() || sameStorage || arraySize + count > arrayCapacity)
+            {
+                std::shared_ptr<T[]> source = array.object; // Keeps the data alive while reallocating
+                reallocate(grownCapacity(arraySize + count), index, count);
+                copyElements(&source[0], &object[index], count);
+            }
+            else
+            {
+                moveElements(&object[index], &object[index + count], arraySize - index);
+                copyElements(&array[0], &object[index], count);
+            }
+
+            // 2) Update the size
+            arraySize = arraySize + count;
         }
 
         /**
             Removes an object from the array given an index
-            Uses memmove to speed up memory operations
+            Uses memmove to shift the end data in place
         */
         void remove(int index)
         {
-            // Create a new object array
-            T* newObject = new T[arraySize - 1];
-
-            // Copy over the old contents to the new one
-            memmove(&newObject[0], &object[0], index * sizeof(T));
-            memmove(&newObject[index], &object[index + 1], (arraySize - index - 1) * sizeof(T));
-
-            // Set the new object array reference
-            object.reset(newObject);
-
-            // Update the size
-            arraySize = arraySize - 1;
+            remove(index, index);
         }
 
         /**
             Removes an object from the array given a range of index to remove
-            Uses memmove to speed up memory operations
+            Uses memmove to shift the end data in place
         */
         void remove(int startIndex, int endIndex)
         {
-            // Create a new object array
-            T* newObject = new T[arraySize + startIndex - endIndex - 1];
-
-            // Copy over the old contents to the new one
-            memmove(&newObject[0], &object[0], startIndex * sizeof(T));
-            memmove(&newObject[startIndex], &object[endIndex + 1], (arraySize - endIndex - 1) * sizeof(T));
-
-            // Set the new object array reference
-            object.reset(newObject);
+            int count = endIndex - startIndex + 1;
+            if (!ownsStorage())
+            {
+                // Copy around the removed range into storage of its own
+                std::shared_ptr<T[]> oldObject = object;
+                int oldSize = arraySize;
+                arraySize = 0;
+                reallocate(oldSize - count);
+                copyElements(&oldObject[0], &object[0], startIndex);
+                copyElements(&oldObject[endIndex + 1], &object[startIndex], oldSize - endIndex - 1);
+                arraySize = oldSize;
+            }
+            else
+                moveElements(&object[endIndex + 1], &object[startIndex], arraySize - endIndex - 1);
 
             // Update the size
-            arraySize = arraySize + startIndex - endIndex - 1;
+            arraySize = arraySize - count;
         }
 
         /* Operator overloading */
-        void operator = (Array& otherArray)
+        Array<T>& operator = (const Array<T> &otherArray)
         {
             /// Deep copy
-            // Update the size
-            arraySize = otherArray.size();
+            if (&otherArray == this)
+                return *this;
 
-            // Create a new object array
-            object.reset(new T[arraySize]);
+            // Create a new object array and copy over the all contents
+            std::shared_ptr<T[]> newObject = allocateStorage<T>(otherArray.size());
+            copyElements(otherArray.getArray(), newObject.get(), otherArray.size());
+            object = std::move(newObject);
 
-            // Copy over the all contents
-            for (int i = 0; i < arraySize; i++)
-                object[i] = otherArray[i];
+            // Update the size
+            arraySize = otherArray.size();
+            arrayCapacity = arraySize;
+            return *this;
         }
 
         T& operator [] (int index)
@@ -163,6 +208,80 @@ class Array
             // Ensuring the object exists, and selecting the correct index is the programmer's job.
             return object[index];
         }
+
+        const T& operator [] (int index) const
+        {
+            return object[index];
+        }
+
+    private:
+        bool ownsStorage() const
+        {
+            return arrayCapacity > 0 && object.use_count() == 1;
+        }
+
+        int grownCapacity(int required) const
+        {
+            int doubled = arrayCapacity > INT_MAX / 2 ? INT_MAX : arrayCapacity * 2;
+            return doubled > required ? doubled : required;
+        }
+
+        /**
+            Moves the elements to new storage of the given capacity, leaving a
+            gap of gapSize elements at gapIndex
+        */
+        void reallocate(int newCapacity, int gapIndex = INT_MAX, int gapSize = 0)
+        {
+            std::shared_ptr<T[]> newObject = allocateStorage<T>(newCapacity);
+            int kept = arraySize < newCapacity ? arraySize : newCapacity;
+            int front = gapIndex < kept ? gapIndex : kept;
+
+            if (object)
+            {
+                // Elements of storage nobody else sees can be moved instead of copied
+                if (ownsStorage())
+                {
+                    std::move(&object[0], &object[0] + front, &newObject[0]);
+                    std::move(&object[0] + front, &object[0] + kept, &newObject[front + gapSize]);
+                }
+                else
+                {
+                    copyElements(&object[0], &newObject[0], front);
+                    copyElements(&object[front], &newObject[front + gapSize], kept - front);
+                }
+            }
+
+            object = std::move(newObject);
+            arrayCapacity = newCapacity;
+        }
+
+        /**
+            Copies count elements between non-overlapping ranges
+        */
+        static void copyElements(const T* source, T* destination, int count)
+        {
+            if (count <= 0)
+                return;
+            if constexpr (std::is_trivially_copyable<T>::value)
+                memcpy(destination, source, count * sizeof(T));
+            else
+                std::copy(source, source + count, destination);
+        }
+
+        /**
+            Moves count elements between possibly overlapping ranges
+        */
+        static void moveElements(T* source, T* destination, int count)
+        {
+            if (count <= 0)
+                return;
+            if constexpr (std::is_trivially_copyable<T>::value)
+                memmove(destination, source, count * sizeof(T));
+            else if (destination < source)
+                std::move(source, source + count, destination);
+            else
+                std::move_backward(source, source + count, destination + count);
+        }
 };
 
 #endif // ARRAY_H_INCLUDED
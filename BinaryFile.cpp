@@ -0,0 +1,182 @@
+#include "BinaryFile.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <stdexcept>
+
+static const char binaryMagic[4] = {'N', 'R', 'N', 'B'};
+static const uint32_t binaryVersion = 1;
+
+/**
+Throws std::runtime_error unless the header describes a file of the
+expected data type whose elements all fit into length bytes
+*/
+static void validateHeader(const BinaryFileHeader &header, const std::string &path, uint32_t dataType, size_t elementSize, size_t length)
+{
+    if (memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) != 0 || header.version != binaryVersion)
+        throw std::runtime_error("BinaryFile: " + path + " is not a binary matrix file");
+    if (header.dataType != dataType)
+        throw std::runtime_error("BinaryFile: " + path + " holds a different data type");
+    if (header.layout != BINARY_COLUMN_MAJOR && header.layout != BINARY_SAMPLE_MAJOR)
+        throw std::runtime_error("BinaryFile: " + path + " has an unsupported layout");
+    if (header.sizeX != 0 && header.sizeY > (length - sizeof(BinaryFileHeader)) / elementSize / header.sizeX)
+        throw std::runtime_error("BinaryFile: " + path + " is shorter than its header states");
+}
+
+std::shared_ptr<void> mapFile(const std::string &path, bool copyOnWrite, size_t &length)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("mapFile: Cannot open " + path);
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        close(file);
+        throw std::runtime_error("mapFile: " + path + " is empty");
+    }
+
+    length = (size_t) status.st_size;
+    int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* address = mmap(nullptr, length, protection, copyOnWrite ? MAP_PRIVATE : MAP_SHARED, file, 0);
+    close(file); // The mapping keeps its own reference to the file
+    if (address == MAP_FAILED)
+        throw std::runtime_error("mapFile: Cannot map " + path);
+
+    // Non-owning as far as the heap is concerned, the last reference unmaps
+    size_t mappedLength = length;
+    return std::shared_ptr<void>(address, [mappedLength](void* mapped){munmap(mapped, mappedLength);});
+}
+
+std::shared_ptr<void> mapBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t &sizeX, uint64_t &sizeY, uint32_t &layout)
+{
+    /// 1) Map the whole file
+    size_t length;
+    std::shared_ptr<void> mapping = mapFile(path, false, length);
+    if (length < sizeof(BinaryFileHeader))
+        throw std::runtime_error("mapBinaryFile: " + path + " is too small to hold a header");
+
+    /// 2) Validate the header against what the caller expects
+    const BinaryFileHeader* header = (const BinaryFileHeader*) mapping.get();
+    validateHeader(*header, path, dataType, elementSize, length);
+    sizeX = header->sizeX;
+    sizeY = header->sizeY;
+    layout = header->layout;
+
+    /// 3) Hand out the elements, sharing ownership of the mapping
+    return std::shared_ptr<void>(mapping, (char*) mapping.get() + sizeof(BinaryFileHeader));
+}
+
+uint64_t computeChecksum(const void* data, size_t length)
+{
+    // 64 bit FNV-1a
+    const unsigned char* bytes = (const unsigned char*) data;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void releaseMappedPages(const void* address, size_t length)
+{
+    // Only whole pages inside the range may be dropped
+    uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t) address + pageSize - 1) / pageSize * pageSize;
+    uintptr_t end = ((uintptr_t) address + length) / pageSize * pageSize;
+    if (start < end)
+        madvise((void*) start, end - start, MADV_DONTNEED);
+}
+
+int openBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t &sizeX, uint64_t &sizeY, uint32_t &layout)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("openBinaryFile: Cannot open " + path);
+
+    BinaryFileHeader header;
+    struct stat status;
+    if (fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(header)
+        || pread(file, &header, sizeof(header), 0) != (ssize_t) sizeof(header))
+    {
+        close(file);
+        throw std::runtime_error("openBinaryFile: Cannot read the header of " + path);
+    }
+
+    try
+    {
+        validateHeader(header, path, dataType, elementSize, (size_t) status.st_size);
+    }
+    catch (...)
+    {
+        close(file);
+        throw;
+    }
+
+    sizeX = header.sizeX;
+    sizeY = header.sizeY;
+    layout = header.layout;
+    return file;
+}
+
+bool readBinaryElements(int file, uint64_t firstElement, size_t count, size_t elementSize, void* destination)
+{
+    char* output = (char*) destination;
+    size_t remaining = count * elementSize;
+    off_t offset = (off_t) (sizeof(BinaryFileHeader) + firstElement * elementSize);
+    while (remaining > 0)
+    {
+        ssize_t bytes = pread(file, output, remaining, offset);
+        if (bytes <= 0)
+            return false;
+        output += bytes;
+        offset += bytes;
+        remaining -= (size_t) bytes;
+    }
+    return true;
+}
+
+void writeBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t sizeX, uint64_t sizeY, const void* data, uint32_t layout)
+{
+    BinaryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+    header.version = binaryVersion;
+    header.dataType = dataType;
+    header.layout = layout;
+    header.sizeX = sizeX;
+    header.sizeY = sizeY;
+
+    replaceFile(path, &header, sizeof(header), data, (size_t) (sizeX * sizeY) * elementSize);
+}
+
+void replaceFile(const std::string &path, const void* header, size_t headerLength, const void* data, size_t dataLength)
+{
+    // A name of its own per process and call, next to path so that the rename stays on one file system
+    static std::atomic<unsigned> fileCounter(0);
+    std::string temporaryPath = path + ".tmp" + std::to_string(getpid()) + "_" + std::to_string(fileCounter.fetch_add(1));
+
+    int descriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    FILE* file = descriptor >= 0 ? fdopen(descriptor, "wb") : nullptr;
+    if (!file)
+    {
+        if (descriptor >= 0)
+            close(descriptor);
+        throw std::runtime_error("replaceFile: Cannot create " + temporaryPath);
+    }
+
+    bool written = fwrite(header, headerLength, 1, file) == 1
+                   && (dataLength == 0 || fwrite(data, dataLength, 1, file) == 1);
+    if (fclose(file) != 0 || !written || rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        unlink(temporaryPath.c_str());
+        throw std::runtime_error("replaceFile: Cannot write " + path);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef BINARYFILE_H_INCLUDED
+#define BINARYFILE_H_INCLUDED
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+/**
+    On-disk format of Matrix and Array binary files:
+
+    A 64 byte header (BinaryFileHeader) followed directly by the elements,
+    stored exactly the way Matrix keeps them in memory, element (x, y) at
+    x * sizeY + y. An Array is stored as sizeX = size, sizeY = 1. The
+    layout records whether a matrix was feature-major or sample-major, see
+    EDataLayout, so that it is mapped back the way it was saved.
+    Multi-byte values are in the byte order of the machine that wrote
+    the file.
+
+    Since the elements start 64 bytes into the file they are as aligned
+    as the page the file is mapped to, and the file can be used in place
+    with mmap instead of being parsed.
+*/
+enum EBinaryDataType
+{
+    BINARY_FLOAT32 = 1,
+    BINARY_FLOAT64 = 2,
+    BINARY_INT32 = 3,
+    BINARY_UINT8 = 4,
+    BINARY_FLOAT16 = 5, // Half, see HalfFloat.h
+    BINARY_BFLOAT16 = 6 // BFloat16
+};
+
+enum EBinaryLayout
+{
+    BINARY_COLUMN_MAJOR = 0, // x * sizeY + y, the Matrix layout, an Array or a feature-major matrix
+    BINARY_SAMPLE_MAJOR = 1 // Same element order, a sample-major matrix (matrix[sample][feature])
+};
+
+struct BinaryFileHeader
+{
+    char magic[4]; // "NRNB"
+    uint32_t version;
+    uint32_t dataType; // EBinaryDataType
+    uint32_t layout; // EBinaryLayout
+    uint64_t sizeX;
+    uint64_t sizeY;
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(BinaryFileHeader) == 64, "The binary file header must stay 64 bytes");
+
+template <class T> struct BinaryDataType;
+template <> struct BinaryDataType<float> {static constexpr uint32_t value = BINARY_FLOAT32;};
+template <> struct BinaryDataType<double> {static constexpr uint32_t value = BINARY_FLOAT64;};
+template <> struct BinaryDataType<int32_t> {static constexpr uint32_t value = BINARY_INT32;};
+template <> struct BinaryDataType<uint8_t> {static constexpr uint32_t value = BINARY_UINT8;};
+
+/**
+    Maps a whole file, read-only and shared or, with copyOnWrite, readable
+    and writable with the writes staying private to the process. length
+    receives the file size. The file is unmapped with the last copy of the
+    returned pointer. Throws std::runtime_error on failure.
+*/
+std::shared_ptr<void> mapFile(const std::string &path, bool copyOnWrite, size_t &length);
+
+/**
+    Maps the file read-only and checks its header against the expected
+    data type and element size. layout receives the EBinaryLayout of the
+    file. Returns the address of the first element;
+    the mapping is released with the last copy of the returned pointer.
+    Throws std::runtime_error if the file cannot be mapped or is not a
+    valid binary file of that type.
+*/
+std::shared_ptr<void> mapBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t &sizeX, uint64_t &sizeY, uint32_t &layout);
+
+uint64_t computeChecksum(const void* data, size_t length); // 64 bit FNV-1a of the bytes
+
+/**
+    Drops the whole pages of a read-only mapping inside the range from the
+    process, they are read from the file again if touched later on
+*/
+void releaseMappedPages(const void* address, size_t length);
+
+/**
+    Opens the file for reading with readBinaryElements and checks its
+    header like mapBinaryFile. Returns the file descriptor, which the
+    caller closes.
+*/
+int openBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t &sizeX, uint64_t &sizeY, uint32_t &layout);
+
+/**
+    Reads count elements starting at element index firstElement (x * sizeY + y),
+    returns false on a read error or a truncated file
+*/
+bool readBinaryElements(int file, uint64_t firstElement, size_t count, size_t elementSize, void* destination);
+
+/**
+    Writes the header and sizeX * sizeY elements through replaceFile,
+    throws std::runtime_error on failure
+*/
+void writeBinaryFile(const std::string &path, uint32_t dataType, size_t elementSize, uint64_t sizeX, uint64_t sizeY, const void* data, uint32_t layout = BINARY_COLUMN_MAJOR);
+
+/**
+    Writes header and data into a new file in the directory of path and
+    renames it over path. A mapping of the previous file, e.g. a matrix
+    or checkpoint that was loaded from path and is being saved back, keeps
+    reading the old contents instead of a truncated file. Throws
+    std::runtime_error on failure, leaving path untouched.
+*/
+void replaceFile(const std::string &path, const void* header, size_t headerLength, const void* data, size_t dataLength);
+
+#endif // BINARYFILE_H_INCLUDED
@@ -0,0 +1,37 @@
+#include "ConvergenceMonitor.h"
+#include <math.h>
+
+ConvergenceMonitor::ConvergenceMonitor()
+{
+    errorTolerance = 0;
+    lossTolerance = -1;
+    weightDeltaTolerance = 0;
+    reset();
+}
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+
+}
+
+void ConvergenceMonitor::reset()
+{
+    epochCount = 0;
+    converged = false;
+    lastEpoch = EpochStatistics();
+}
+
+bool ConvergenceMonitor::endEpoch(const EpochStatistics &statistics)
+{
+    if (onEpoch)
+        onEpoch(statistics);
+
+    bool lossSettled = lossTolerance >= 0 && epochCount > 0 && fabsf(statistics.loss - lastEpoch.loss) <= lossTolerance;
+    converged = (errorTolerance >= 0 && statistics.errorCount <= errorTolerance)
+                || lossSettled
+                || (weightDeltaTolerance >= 0 && statistics.weightDeltaNorm <= weightDeltaTolerance);
+
+    lastEpoch = statistics;
+    epochCount++;
+    return converged;
+}
@@ -0,0 +1,50 @@
+#ifndef CONVERGENCEMONITOR_H
+#define CONVERGENCEMONITOR_H
+
+#include <functional>
+
+/**
+    Statistics of one epoch of delta learning, gathered during the pass
+    itself. Every sample is judged by the response it got before its own
+    update.
+*/
+struct EpochStatistics
+{
+    int epoch; // From 1
+    int sampleCount;
+    int errorCount; // Samples whose response was 0.5 or more away from their target, i.e. misclassified for 0/1 targets
+    float loss; // Mean of (t - y)^2 / 2
+    float weightDeltaNorm; // Euclidean norm of the change of the weight vector over the epoch
+};
+
+/**
+    Early stopping for Neuron::deltaLearning: the epoch count passed in
+    becomes a maximum and learning stops after the first epoch meeting
+    any of the enabled tolerances. A negative tolerance disables its test.
+    onEpoch, when set, is called with the statistics of every epoch.
+*/
+class ConvergenceMonitor
+{
+    public:
+        ConvergenceMonitor();
+        ~ConvergenceMonitor();
+
+        bool endEpoch(const EpochStatistics &statistics); // Records an epoch, true if learning should stop
+        void reset(); // Forgets the epochs recorded, for the next learning run
+
+        bool hasConverged() const {return converged;}
+        int getEpochCount() const {return epochCount;}
+        const EpochStatistics &getLastEpoch() const {return lastEpoch;}
+
+        int errorTolerance; // Stop once an epoch has at most this many errors, 0 by default
+        float lossTolerance; // Stop once the loss changes by at most this much from the previous epoch, disabled by default
+        float weightDeltaTolerance; // Stop once the weights change by at most this much (norm) over an epoch, 0 by default
+        std::function<void(const EpochStatistics &)> onEpoch;
+
+    private:
+        int epochCount;
+        bool converged;
+        EpochStatistics lastEpoch;
+};
+
+#endif // CONVERGENCEMONITOR_H
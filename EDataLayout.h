@@ -0,0 +1,16 @@
+#ifndef EDATALAYOUT_H_INCLUDED
+#define EDATALAYOUT_H_INCLUDED
+
+/**
+    How the samples of a data set are laid out in a Matrix
+*/
+enum EDataLayout
+{
+    // 0
+    FEATURE_MAJOR, // featureMatrix[feature][sample], a feature of every sample is contiguous
+
+    // 1
+    SAMPLE_MAJOR // featureMatrix[sample][feature], every sample is contiguous
+};
+
+#endif // EDATALAYOUT_H_INCLUDED
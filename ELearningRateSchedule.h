@@ -0,0 +1,23 @@
+#ifndef ELEARNINGRATESCHEDULE_H_INCLUDED
+#define ELEARNINGRATESCHEDULE_H_INCLUDED
+
+/**
+    How the learning rate of online learning changes with the number of
+    updates t made so far, n0 being the initial rate (see LearningRateSchedule.h)
+*/
+enum ELearningRateSchedule
+{
+    // 0
+    CONSTANT_RATE, // n0
+
+    // 1
+    INVERSE_TIME_DECAY, // n0 / (1 + decay * t)
+
+    // 2
+    INVERSE_SQRT_DECAY, // n0 / sqrt(1 + decay * t)
+
+    // 3
+    EXPONENTIAL_DECAY // n0 * exp(-decay * t)
+};
+
+#endif // ELEARNINGRATESCHEDULE_H_INCLUDED
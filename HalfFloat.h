@@ -0,0 +1,143 @@
+#ifndef HALFFLOAT_H_INCLUDED
+#define HALFFLOAT_H_INCLUDED
+
+#include <stdint.h>
+#include <string.h>
+
+#include "BinaryFile.h"
+
+/**
+    16 bit storage types for Matrix: IEEE half precision (Half, 5 bit
+    exponent, 10 bit mantissa) and bfloat16 (BFloat16, the top half of a
+    float: same 8 bit exponent, 7 bit mantissa). They only store values;
+    arithmetic converts them to float, and the products of Matrix::dot and
+    the Neuron paths accumulate in float.
+    Conversions from float round to nearest even. The array conversions
+    below are vectorised with F16C and AVX-512 BF16 (or AVX2) when the CPU
+    has them, the kernel being chosen once at runtime.
+*/
+inline float bitsToFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint32_t floatToBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float halfBitsToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+
+    if (exponent == 0x1F) // Infinity or NaN
+        return bitsToFloat(sign | 0x7F800000 | (mantissa << 13));
+    if (exponent != 0) // Normal
+        return bitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+
+    // Zero or subnormal, mantissa * 2^-24
+    float magnitude = (float) mantissa * bitsToFloat(0x33800000);
+    return sign ? -magnitude : magnitude;
+}
+
+inline uint16_t floatToHalfBits(float value)
+{
+    uint32_t bits = floatToBits(value);
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    if (magnitude > 0x7F800000) // NaN, kept quiet
+        return sign | 0x7E00 | (uint16_t) ((magnitude >> 13) & 0x3FF);
+    if (magnitude >= 0x477FF000) // Rounds to 65520 or more, infinity
+        return sign | 0x7C00;
+    if (magnitude < 0x38800000) // Below the smallest normal half, 2^-14
+    {
+        // Scaling by 2^24 turns the subnormal half into an integer, rounded to nearest even by the FPU
+        float scaled = bitsToFloat(magnitude) * bitsToFloat(0x4B800000);
+        return sign | (uint16_t) __builtin_lrintf(scaled);
+    }
+
+    // Normal: rebias the exponent and round the 13 dropped mantissa bits to nearest even
+    uint32_t rounded = magnitude + 0xFFF + ((magnitude >> 13) & 1);
+    return sign | (uint16_t) ((rounded - (112u << 23)) >> 13);
+}
+
+inline float bfloatBitsToFloat(uint16_t bfloat)
+{
+    return bitsToFloat((uint32_t) bfloat << 16);
+}
+
+inline uint16_t floatToBfloatBits(float value)
+{
+    uint32_t bits = floatToBits(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) // NaN, kept quiet
+        return (uint16_t) ((bits >> 16) | 0x40);
+    return (uint16_t) ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+struct Half
+{
+    uint16_t bits;
+
+    Half() = default;
+    Half(float value) : bits(floatToHalfBits(value)) {}
+    operator float() const {return halfBitsToFloat(bits);}
+
+    Half& operator += (float value) {return *this = (float) *this + value;}
+    Half& operator -= (float value) {return *this = (float) *this - value;}
+    Half& operator *= (float value) {return *this = (float) *this * value;}
+    Half& operator /= (float value) {return *this = (float) *this / value;}
+};
+
+struct BFloat16
+{
+    uint16_t bits;
+
+    BFloat16() = default;
+    BFloat16(float value) : bits(floatToBfloatBits(value)) {}
+    operator float() const {return bfloatBitsToFloat(bits);}
+
+    BFloat16& operator += (float value) {return *this = (float) *this + value;}
+    BFloat16& operator -= (float value) {return *this = (float) *this - value;}
+    BFloat16& operator *= (float value) {return *this = (float) *this * value;}
+    BFloat16& operator /= (float value) {return *this = (float) *this / value;}
+};
+
+template <class T> struct IsHalfFloat {static constexpr bool value = false;};
+template <> struct IsHalfFloat<Half> {static constexpr bool value = true;};
+template <> struct IsHalfFloat<BFloat16> {static constexpr bool value = true;};
+
+template <> struct BinaryDataType<Half> {static constexpr uint32_t value = BINARY_FLOAT16;};
+template <> struct BinaryDataType<BFloat16> {static constexpr uint32_t value = BINARY_BFLOAT16;};
+
+/// Vectorised array conversions
+void convertToFloat(const Half* source, float* destination, long long count);
+void convertToFloat(const BFloat16* source, float* destination, long long count);
+void convertFromFloat(const float* source, Half* destination, long long count);
+void convertFromFloat(const float* source, BFloat16* destination, long long count);
+const char* getHalfKernelName(); // Name of the Half conversion kernel chosen for this CPU
+const char* getBFloat16KernelName(); // Same for BFloat16
+
+/**
+    Converts count elements of one type to another, element by element
+    unless one of the vectorised conversions above applies
+*/
+template <class Source, class Destination>
+inline void convertElements(const Source* source, Destination* destination, long long count)
+{
+    for (long long i = 0; i < count; i++)
+        destination[i] = (Destination) source[i];
+}
+
+inline void convertElements(const Half* source, float* destination, long long count) {convertToFloat(source, destination, count);}
+inline void convertElements(const BFloat16* source, float* destination, long long count) {convertToFloat(source, destination, count);}
+inline void convertElements(const float* source, Half* destination, long long count) {convertFromFloat(source, destination, count);}
+inline void convertElements(const float* source, BFloat16* destination, long long count) {convertFromFloat(source, destination, count);}
+
+#endif // HALFFLOAT_H_INCLUDED
@@ -0,0 +1,107 @@
+#include "Layer.h"
+#include <math.h>
+#include <stdlib.h>
+
+Layer::Layer(int inputSize, int outputSize, EActivationFunction activationFunction)
+{
+    activationFunctionEnum = activationFunction;
+    approximateActivation = false;
+    weightMatrix.setSize(outputSize, inputSize);
+    biasMatrix.setSize(outputSize, 1);
+    weightGradient.setSize(outputSize, inputSize);
+    biasGradient.setSize(outputSize, 1);
+    initWeightMatrix();
+}
+
+Layer::~Layer()
+{
+
+}
+
+void Layer::initWeightMatrix()
+{
+    // Glorot uniform range, keeps the activations of deeper layers from saturating
+    float range = sqrtf(6.0f / (getInputSize() + getOutputSize()));
+    for (long long i = 0; i < weightMatrix.getSize(); i++)
+        weightMatrix.getArrayRef()[i] = ((float) rand() / RAND_MAX * 2.0f - 1.0f) * range;
+    biasMatrix.fill(0);
+}
+
+void Layer::forward(Matrix<float> &input)
+{
+    int batchSize = input.getSizeY();
+    int outputSize = getOutputSize();
+
+    // Net input of every unit for every sample in one product
+    netInputMatrix.dot(input, weightMatrix);
+
+    // The output starts as a copy of the net input, so size it the same way
+    if (outputMatrix.getSizeX() != outputSize || outputMatrix.getSizeY() != batchSize)
+        outputMatrix.setSize(outputSize, batchSize);
+
+    const float* bias = biasMatrix.getArrayRef();
+    float* netInput = netInputMatrix.getArrayRef();
+    float* output = outputMatrix.getArrayRef();
+    for (int o = 0; o < outputSize; o++)
+    {
+        float* netInputColumn = netInput + (long long) o * batchSize;
+        float* outputColumn = output + (long long) o * batchSize;
+        for (int j = 0; j < batchSize; j++)
+        {
+            netInputColumn[j] += bias[o];
+            outputColumn[j] = netInputColumn[j];
+        }
+    }
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        activation.apply(output, outputMatrix.getSize());
+    });
+}
+
+/**
+Given the gradient of the loss with respect to this layer's output,
+computes the gradients of the weights and biases and, when asked for,
+with respect to the layer's input for the layer before it.
+Must follow the forward pass of the same input.
+*/
+void Layer::backward(Matrix<float> &input, Matrix<float> &outputGradient, Matrix<float> *inputGradient)
+{
+    int batchSize = input.getSizeY();
+    int outputSize = getOutputSize();
+
+    // delta = dL/dy * f'(net)
+    if (deltaMatrix.getSizeX() != outputSize || deltaMatrix.getSizeY() != batchSize)
+        deltaMatrix.setSize(outputSize, batchSize);
+    float* delta = deltaMatrix.getArrayRef();
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        activation.derivative(netInputMatrix.getArrayRef(), delta, deltaMatrix.getSize());
+    });
+    const float* gradient = outputGradient.getArrayRef();
+    for (long long i = 0; i < deltaMatrix.getSize(); i++)
+        delta[i] *= gradient[i];
+
+    // dL/dW = input^T * delta, dL/db = column sums of delta
+    weightGradient.dot(input, deltaMatrix, true, false);
+    float* biasDelta = biasGradient.getArrayRef();
+    for (int o = 0; o < outputSize; o++)
+    {
+        const float* deltaColumn = delta + (long long) o * batchSize;
+        float sum = 0;
+        for (int j = 0; j < batchSize; j++)
+            sum += deltaColumn[j];
+        biasDelta[o] = sum;
+    }
+
+    // dL/dinput = delta * W^T
+    if (inputGradient)
+        inputGradient->dot(deltaMatrix, weightMatrix, false, true);
+}
+
+void Layer::update(float learningRate)
+{
+    // Fused single pass updates, see MatrixExpression.h
+    weightMatrix = weightMatrix - learningRate * weightGradient;
+    biasMatrix = biasMatrix - learningRate * biasGradient;
+}
@@ -0,0 +1,47 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "Matrix.h"
+#include "Activation.h"
+
+/**
+    A fully connected layer of neurons evaluated a whole batch at a time.
+    Samples are rows and units are columns in every matrix, the same
+    layout as the feature matrices used by Neuron (matrix[unit][sample]).
+
+    All neurons share one weight matrix: column o, weightMatrix[o], holds
+    the input weights of output unit o, biasMatrix[o][0] its bias.
+    The forward and backward passes are matrix products through
+    Matrix::dot into buffers that are kept between calls, so they only
+    allocate when the batch size changes.
+*/
+class Layer
+{
+    public:
+        Layer(int inputSize, int outputSize, EActivationFunction activationFunction);
+        ~Layer();
+
+        void initWeightMatrix(); // Uniform random weights scaled by the layer size, zero biases
+
+        void forward(Matrix<float> &input); // outputMatrix = f(input * weightMatrix + bias)
+        void backward(Matrix<float> &input, Matrix<float> &outputGradient, Matrix<float> *inputGradient); // Gradients of the loss, inputGradient may be null
+        void update(float learningRate); // Gradient descent step with the gradients of the last backward pass
+
+        int getInputSize() const {return weightMatrix.getSizeY();}
+        int getOutputSize() const {return weightMatrix.getSizeX();}
+
+        EActivationFunction activationFunctionEnum;
+        bool approximateActivation; // Use the fast approximations of FastMath.h in the activation function
+        Matrix<float> weightMatrix; // inputSize rows x outputSize columns
+        Matrix<float> biasMatrix; // 1 row x outputSize columns
+
+        Matrix<float> netInputMatrix; // batch x outputSize, kept for the backward pass
+        Matrix<float> outputMatrix; // batch x outputSize
+
+    private:
+        Matrix<float> deltaMatrix; // batch x outputSize, gradient of the loss with respect to the net input
+        Matrix<float> weightGradient;
+        Matrix<float> biasGradient;
+};
+
+#endif // LAYER_H
@@ -0,0 +1,33 @@
+#ifndef LEARNINGRATESCHEDULE_H_INCLUDED
+#define LEARNINGRATESCHEDULE_H_INCLUDED
+
+#include <math.h>
+
+#include "ELearningRateSchedule.h"
+
+/**
+    Learning rate of Neuron::partialFit as a function of the number of
+    updates made so far
+*/
+struct LearningRateSchedule
+{
+    ELearningRateSchedule schedule;
+    float initialRate;
+    float decay;
+
+    LearningRateSchedule(ELearningRateSchedule schedule = CONSTANT_RATE, float initialRate = 0.01f, float decay = 0) : schedule(schedule), initialRate(initialRate), decay(decay) {}
+
+    float rate(long long updateCount) const
+    {
+        float t = (float) updateCount;
+        switch (schedule)
+        {
+            case INVERSE_TIME_DECAY: return initialRate / (1 + decay * t);
+            case INVERSE_SQRT_DECAY: return initialRate / sqrtf(1 + decay * t);
+            case EXPONENTIAL_DECAY: return initialRate * expf(-decay * t);
+            default: return initialRate;
+        }
+    }
+};
+
+#endif // LEARNINGRATESCHEDULE_H_INCLUDED
@@ -2,8 +2,72 @@
 #define MATRIX_H_INCLUDED
 
 #include <memory>
+#include <climits>
+#include <string>
 #include <math.h>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#include "Gemm.h"
+#include "Transpose.h"
+#include "MatrixExpression.h"
+#include "Storage.h"
+#include "BinaryFile.h"
+#include "EDataLayout.h"
+#include "HalfFloat.h"
+
+/**
+    Non-owning view of a matrix or of a rectangular part of it, addressed
+    the same way: column x starts at x * stride and its rows are contiguous.
+    A view is a plain value (pointer, sizes, stride), copying it copies
+    nothing and it does not keep the viewed storage alive.
+*/
+template <class T>
+class MatrixView
+{
+    T* data;
+    int sizeX, sizeY;
+    long long stride;
+
+    public:
+        MatrixView() : data(nullptr), sizeX(0), sizeY(0), stride(0) {}
+        MatrixView(T* _data, int _sizeX, int _sizeY, long long _stride) : data(_data), sizeX(_sizeX), sizeY(_sizeY), stride(_stride) {}
+
+        // A view of T converts to a view of const T
+        template <class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        MatrixView(const MatrixView<U> &view) : data(view.getArrayRef()), sizeX(view.getSizeX()), sizeY(view.getSizeY()), stride(view.getStride()) {}
+
+        int getSizeX() const {return sizeX;}
+        int getSizeY() const {return sizeY;}
+        long long getSize() const {return (long long) sizeX * sizeY;}
+        long long getStride() const {return stride;}
+        T* getArrayRef() const {return data;}
+
+        T& getElement(int x, int y) const
+        {
+            return data[x * stride + y];
+        }
+
+        T* operator [] (int index) const
+        {
+            return data + index * stride;
+        }
+
+        /**
+        View of a part of this view, the bounds are inclusive and limited
+        the same way as in Matrix::subMatrix
+        */
+        MatrixView<T> subView(int minX, int maxX, int minY, int maxY) const
+        {
+            if (minX < 0) minX = 0;
+            if (maxX >= sizeX) maxX = sizeX - 1;
+            if (minY < 0) minY = 0;
+            if (maxY >= sizeY) maxY = sizeY - 1;
+            return MatrixView<T>(data + minX * stride + minY, maxX - minX + 1, maxY - minY + 1, stride);
+        }
+};
 
 /**
     UPDATE: 8/7/2018
@@ -19,24 +83,110 @@ class Matrix
 {
     std::shared_ptr<T[]> ptr;
     int sizeX, sizeY;
+    EDataLayout layout = FEATURE_MAJOR; // Only meaningful for feature matrices, see getLayout
+    const T* adoptedStorage = nullptr; // Storage taken over by setStorage, never reused for results, see ownsStorage
 
     public:
         Matrix(){sizeX = 0; sizeY = 0;}
         Matrix(int _sizeX, int _sizeY) : sizeX(_sizeX), sizeY(_sizeY)
-            {ptr.reset(new T[sizeX * sizeY]);};
+            {ptr = allocateStorage<T>((long long) sizeX * sizeY);};
+        Matrix(const Matrix<T> &matrix) = default; // Shares the storage, assignment copies it
+        Matrix(Matrix<T> &&matrix) noexcept : ptr(std::move(matrix.ptr)), sizeX(matrix.sizeX), sizeY(matrix.sizeY), layout(matrix.layout), adoptedStorage(matrix.adoptedStorage)
+            {matrix.sizeX = 0; matrix.sizeY = 0;}
+
+        template <class Expression, class = typename std::enable_if<std::is_base_of<MatrixExpressionTag, Expression>::value>::type>
+        Matrix(const Expression &expression) : sizeX(expression.getSizeX()), sizeY(expression.getSizeY())
+        {
+            ptr = allocateStorage<T>((long long) sizeX * sizeY);
+            evaluate(expression, ptr.get());
+        }
+
+        /**
+        Copies the elements of a view into a new matrix
+        */
+        template <class U>
+        explicit Matrix(const MatrixView<U> &view) : sizeX(view.getSizeX()), sizeY(view.getSizeY())
+        {
+            ptr = allocateStorage<T>((long long) sizeX * sizeY);
+            for (int x = 0; x < sizeX; x++)
+                for (int y = 0; y < sizeY; y++)
+                    ptr[(long long) x * sizeY + y] = view[x][y];
+        }
+
+        /**
+        Copies a matrix of another element type, converting its elements,
+        e.g. between float and the 16 bit types of HalfFloat.h (vectorised)
+        */
+        template <class U>
+        explicit Matrix(const Matrix<U> &matrix) : sizeX(matrix.getSizeX()), sizeY(matrix.getSizeY()), layout(matrix.getLayout())
+        {
+            ptr = allocateStorage<T>((long long) sizeX * sizeY);
+            convertElements(matrix.getArrayRef(), ptr.get(), (long long) sizeX * sizeY);
+        }
+
+        /**
+        Maps a binary file written by save (see BinaryFile.h) instead of
+        loading it, so the elements are paged in lazily as they are first
+        read, with the layout it was saved with. The mapping is read-only:
+        writing to the elements crashes, assign the matrix to another one
+        for a writable copy. Assigning an expression or a product to it and
+        transposeInPlace move it to storage of its own. Throws
+        std::runtime_error if the file is missing or of another type.
+        */
+        explicit Matrix(const std::string &path)
+        {
+            uint64_t fileSizeX, fileSizeY;
+            uint32_t fileLayout;
+            std::shared_ptr<void> elements = mapBinaryFile(path, BinaryDataType<T>::value, sizeof(T), fileSizeX, fileSizeY, fileLayout);
+            if (fileSizeX > INT_MAX || fileSizeY > INT_MAX)
+                throw std::runtime_error("Matrix: " + path + " has more columns or rows than a Matrix can index");
+            setStorage(std::shared_ptr<T[]>(elements, (T*) elements.get()), (int) fileSizeX, (int) fileSizeY);
+            layout = fileLayout == BINARY_SAMPLE_MAJOR ? SAMPLE_MAJOR : FEATURE_MAJOR;
+        }
         ~Matrix(){};
 
         // Methods
         int getSizeX() const {return sizeX;}
         int getSizeY() const {return sizeY;}
-        int getSize() const { return sizeX * sizeY;}
+        long long getSize() const { return (long long) sizeX * sizeY;}
+
+        /**
+        Layout of the samples when the matrix holds a data set. Feature
+        matrices are feature-major (featureMatrix[feature][sample]) unless
+        set otherwise; transpose switches between both layouts.
+        */
+        EDataLayout getLayout() const {return layout;}
+        void setLayout(EDataLayout newLayout) {layout = newLayout;}
+
+        /// Data set dimensions and strides following the layout
+        int getFeatureCount() const {return layout == SAMPLE_MAJOR ? sizeY : sizeX;}
+        int getSampleCount() const {return layout == SAMPLE_MAJOR ? sizeX : sizeY;}
+        long long getFeatureStride() const {return layout == SAMPLE_MAJOR ? 1 : sizeY;} // Distance between two features of a sample
+        long long getSampleStride() const {return layout == SAMPLE_MAJOR ? sizeY : 1;} // Distance between two samples of a feature
 
         /**
         Matrix element access method
         */
         T& getElement(int x, int y)
         {
-            return ptr[x * sizeY + y];
+            return ptr[(long long) x * sizeY + y];
+        }
+
+        const T& getElement(int x, int y) const
+        {
+            return ptr[(long long) x * sizeY + y];
+        }
+
+        MatrixView<T> view() {return MatrixView<T>(ptr.get(), sizeX, sizeY, sizeY);}
+        MatrixView<const T> view() const {return MatrixView<const T>(ptr.get(), sizeX, sizeY, sizeY);}
+
+        /**
+        Non-copying counterpart of subMatrix, the view is only valid
+        while this matrix keeps its storage
+        */
+        MatrixView<T> subMatrixView(int minX, int maxX, int minY, int maxY)
+        {
+            return view().subView(minX, maxX, minY, maxY);
         }
 
         /**
@@ -45,20 +195,7 @@ class Matrix
         */
         Matrix<T> subMatrix(int minX, int maxX, int minY, int maxY)
         {
-            /// 1) Limit the parameters
-            if (minX < 0) minX = 0;
-            if (maxX >= sizeX) maxX = sizeX - 1;
-            if (minY < 0) minY = 0;
-            if (maxY >= sizeY) maxY = sizeY - 1;
-
-            /// 2) Create the sub matrix
-            Matrix<T> matrix(maxX - minX + 1, maxY - minY + 1);
-            for (int x = 0; x < matrix.getSizeX(); x++)
-                for (int y = 0; y < matrix.getSizeY(); y++)
-                    matrix[x][y] = (*this)[x + minX][y + minY];
-
-            /// 3) Return the sub matrix
-            return matrix;
+            return Matrix<T>(subMatrixView(minX, maxX, minY, maxY));
         }
 
         /**
@@ -66,29 +203,48 @@ class Matrix
         */
         void fill(T value)
         {
-            for (int i = 0; i < sizeX * sizeY; i++)
+            for (long long i = 0; i < (long long) sizeX * sizeY; i++)
                 ptr[i] = value;
         }
 
         /// Operators
         T* operator [] (int index)
         {
-            return &ptr[index * sizeY];
+            return &ptr[(long long) index * sizeY];
+        }
+
+        const T* operator [] (int index) const
+        {
+            return &ptr[(long long) index * sizeY];
         }
 
         void setSize(int newSizeX, int newSizeY)
         {
-            T* newArray = new T[newSizeX * newSizeY];
+            std::shared_ptr<T[]> newArray = allocateStorage<T>((long long) newSizeX * newSizeY);
 
             // Copy over the array contents of the current array to the new array.
             for (int y = 0; y < newSizeY && y < sizeY; y++)
                 for (int x = 0; x < newSizeX && x < sizeX; x++)
                 {
-                    newArray[(x * newSizeY) + y] = ptr[(x * sizeY) + y];
+                    newArray[((long long) x * newSizeY) + y] = ptr[((long long) x * sizeY) + y];
                 }
 
             // Delete the old array as it is no longer needed
-            ptr.reset(newArray);
+            ptr = std::move(newArray);
+            sizeX = newSizeX;
+            sizeY = newSizeY;
+        }
+
+        /**
+        Adopts storage owned elsewhere (e.g. a file mapping) without copying,
+        it must hold at least newSizeX * newSizeY elements. Results of
+        expressions, products and transposeInPlace are never written into it,
+        they go to storage of the matrix's own.
+        */
+        void setStorage(std::shared_ptr<T[]> storage, int newSizeX, int newSizeY)
+        {
+            ptr = storage;
+            adoptedStorage = storage.get();
             sizeX = newSizeX;
             sizeY = newSizeY;
         }
@@ -98,68 +254,89 @@ class Matrix
             return ptr.get();
         }
 
-//        void operator= (Matrix<T> &matrix) // Deep copy for same typed matrices
-        void operator= (Matrix<T> matrix) // Deep copy for same typed matrices
+        const T* getArrayRef() const
         {
-            sizeX = matrix.getSizeX();
-            sizeY = matrix.getSizeY();
-            ptr.reset(new T[sizeX * sizeY]);
-            for (int y = 0; y < sizeY; y++)
-                for (int x = 0; x < sizeX; x++)
-                    ptr[(x * sizeY) + y] = matrix[x][y];
+            return ptr.get();
         }
 
-        void operator= (Matrix<T> *matrix) // Deep copy for same typed matrices
+        /**
+        Writes the matrix and its layout in the binary format the path
+        constructor maps
+        */
+        void save(const std::string &path) const
         {
-            sizeX = matrix->getSizeX();
-            sizeY = matrix->getSizeY();
-            ptr.reset(new T[sizeX * sizeY]);
-            for (int y = 0; y < sizeY; y++)
-                for (int x = 0; x < sizeX; x++)
-                    ptr[(x * sizeY) + y] = (*matrix)[x][y];
+            writeBinaryFile(path, BinaryDataType<T>::value, sizeof(T), sizeX, sizeY, ptr.get(), layout == SAMPLE_MAJOR ? BINARY_SAMPLE_MAJOR : BINARY_COLUMN_MAJOR);
         }
 
-        Matrix<T> operator + (Matrix<T> matrix)
+        Matrix<T>& operator= (const Matrix<T> &matrix) // Deep copy for same typed matrices
         {
-            if (sizeX == matrix.getSizeX() && sizeY == matrix.getSizeY())
+            if (this != &matrix)
             {
-                Matrix<T> toReturn;
-                toReturn.setSize(sizeX, sizeY);
-                for (int x = 0; x < sizeX ; x++)
-                    for (int y = 0; y < sizeY ; y++)
-                        toReturn[x][y] = (*this)[x][y] + matrix[x][y];
-                return toReturn;
+                std::shared_ptr<T[]> newArray = allocateStorage<T>(matrix.getSize());
+                std::copy(matrix.getArrayRef(), matrix.getArrayRef() + matrix.getSize(), newArray.get());
+                ptr = std::move(newArray);
+                sizeX = matrix.getSizeX();
+                sizeY = matrix.getSizeY();
+                layout = matrix.getLayout();
             }
+            return *this;
+        }
+
+        /**
+        Evaluates an elementwise expression (see MatrixExpression.h) in one
+        pass, writing straight into the current storage when it already has
+        the size and is owned by this matrix alone
+        */
+        template <class Expression, class = typename std::enable_if<std::is_base_of<MatrixExpressionTag, Expression>::value>::type>
+        Matrix<T>& operator= (const Expression &expression)
+        {
+            int newSizeX = expression.getSizeX();
+            int newSizeY = expression.getSizeY();
+            if (sizeX == newSizeX && sizeY == newSizeY && ownsStorage())
+                evaluate(expression, ptr.get());
             else
             {
-                std::cout << "Matrix passed for addition operator is of different size than expected! (" << sizeX <<  ", " << sizeY << ") != (" << matrix.getSizeX() <<  ", " << matrix.getSizeY() << ")" << std::endl;
-                throw std::invalid_argument("Matrix passed for addition operator is of different size than expected!");
+                // The expression may still read the old storage
+                std::shared_ptr<T[]> newArray = allocateStorage<T>((long long) newSizeX * newSizeY);
+                evaluate(expression, newArray.get());
+                ptr = std::move(newArray);
+                sizeX = newSizeX;
+                sizeY = newSizeY;
             }
+            return *this;
         }
 
-        Matrix<T> operator - (Matrix<T> matrix)
+        Matrix<T>& operator= (Matrix<T> &&matrix) noexcept // Takes over the storage of a temporary
         {
-            if (sizeX == matrix.getSizeX() && sizeY == matrix.getSizeY())
-            {
-                Matrix<T> toReturn;
-                toReturn.setSize(sizeX, sizeY);
-                for (int x = 0; x < sizeX ; x++)
-                    for (int y = 0; y < sizeY ; y++)
-                        toReturn[x][y] = (*this)[x][y] - matrix[x][y];
-                return toReturn;
-            }
-            else
+            if (this != &matrix)
             {
-                std::cout << "Matrix passed for addition operator is of different size than expected! (" << sizeX <<  ", " << sizeY << ") != (" << matrix.getSizeX() <<  ", " << matrix.getSizeY() << ")" << std::endl;
-                throw std::invalid_argument("Matrix passed for addition operator is of different size than expected!");
+                ptr = std::move(matrix.ptr);
+                sizeX = matrix.sizeX;
+                sizeY = matrix.sizeY;
+                layout = matrix.layout;
+                adoptedStorage = matrix.adoptedStorage;
+                matrix.sizeX = 0;
+                matrix.sizeY = 0;
             }
+            return *this;
+        }
+
+        void operator= (Matrix<T> *matrix) // Deep copy for same typed matrices
+        {
+            sizeX = matrix->getSizeX();
+            sizeY = matrix->getSizeY();
+            layout = matrix->getLayout();
+            ptr = allocateStorage<T>((long long) sizeX * sizeY);
+            for (int y = 0; y < sizeY; y++)
+                for (int x = 0; x < sizeX; x++)
+                    ptr[((long long) x * sizeY) + y] = (*matrix)[x][y];
         }
 
         /// Numerical operations on matrices
         /**
         Produces the result of adding both matrices given that they apply
         */
-        void add(Matrix<T> &matrix1, Matrix<T> &matrix2)
+        void add(const Matrix<T> &matrix1, const Matrix<T> &matrix2)
         {
             // Check if both matrices have the same dimensions
             if (matrix1.getSizeX() == matrix2.getSizeX() && matrix1.getSizeY() == matrix2.getSizeY())
@@ -167,14 +344,14 @@ class Matrix
                 // Reassign memory space for the pointer to match the size of the two matrices
                 sizeX = matrix1.getSizeX();
                 sizeY = matrix1.getSizeY();
-                ptr.reset(new T[sizeX * sizeY]);
+                ptr = allocateStorage<T>((long long) sizeX * sizeY);
 
                 // Perform addition on both matrices to this matrix
                 for (int x = 0; x < sizeX ; x++)
                 {
                     for (int y = 0; y < sizeY ; y++)
                     {
-                        ptr[x * sizeY + y] = matrix1[x][y] + matrix2[x][y];
+                        ptr[(long long) x * sizeY + y] = matrix1[x][y] + matrix2[x][y];
                     }
                 }
             }
@@ -183,7 +360,7 @@ class Matrix
         /**
         Produces the result of adding both matrices given that they apply
         */
-        void deduct(Matrix<T> &matrix1, Matrix<T> &matrix2)
+        void deduct(const Matrix<T> &matrix1, const Matrix<T> &matrix2)
         {
             // Check if both matrices have the same dimensions
             if (matrix1.getSizeX() == matrix2.getSizeX() && matrix1.getSizeY() == matrix2.getSizeY())
@@ -191,14 +368,14 @@ class Matrix
                 // Reassign memory space for the pointer to match the size of the two matrices
                 sizeX = matrix1.getSizeX();
                 sizeY = matrix1.getSizeY();
-                ptr.reset(new T[sizeX * sizeY]);
+                ptr = allocateStorage<T>((long long) sizeX * sizeY);
 
                 // Perform addition on both matrices to this matrix
                 for (int x = 0; x < sizeX ; x++)
                 {
                     for (int y = 0; y < sizeY ; y++)
                     {
-                        ptr[x * sizeY + y] = matrix1[x][y] - matrix2[x][y];
+                        ptr[(long long) x * sizeY + y] = matrix1[x][y] - matrix2[x][y];
                     }
                 }
             }
@@ -214,7 +391,7 @@ class Matrix
             {
                 for (int y = 0; y < sizeY; y++)
                 {
-                    ptr[x * sizeY + y] *= value;
+                    ptr[(long long) x * sizeY + y] *= value;
                 }
             }
         }
@@ -222,34 +399,48 @@ class Matrix
         /**
         Dot product
         Produces the result of multiplying both matrices given that they apply
-        Algorithm: Naive multiplication O(n^3)
+        Algorithm: Cache blocked, register tiled SIMD multiplication (see Gemm.h)
+        for float and double, and for Half and BFloat16 through float copies of
+        the operands, so that they accumulate in float. Naive multiplication
+        O(n^3) otherwise.
+        The current storage is reused when it already has the result size and
+        is neither shared nor one of the operands.
         */
-        void dot(Matrix<T> matrix1, Matrix<T> matrix2)
+        void dot(const Matrix<T> &matrix1, const Matrix<T> &matrix2)
         {
             // Checking if the both matrices are compatible for multiplication
             if (matrix1.getSizeX() == matrix2.getSizeY())
             {
-                // Reassign memory space for the pointer to match the size of the two matrices
                 int x1 = matrix1.getSizeX();
                 int x2 = matrix2.getSizeX();
                 int y1 = matrix1.getSizeY();
-                // int y2 = matrix2.getSizeY();
-                ptr.reset(new T[x2 * y1]);
-                sizeX = x2;
-                sizeY = y1;
-
-                // Perform multiplication on both matrices
-                for (int i1 = 0; i1 < y1; i1++)
-                {
-                    for (int i2 = 0; i2 < x2; i2++)
-                    {
-                        T sum = 0;
-                        for (int i3 = 0; i3 < x1; i3++)
-                            sum += matrix1[i3][i1] * matrix2[i2][i3];
+                prepareProduct(x2, y1, matrix1, matrix2);
+
+                if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value)
+                    gemm(y1, x2, x1, matrix1.getArrayRef(), y1, matrix2.getArrayRef(), x1, ptr.get(), y1);
+                else if constexpr (IsHalfFloat<T>::value)
+                    widenedProduct(matrix1, matrix2, false, false);
+                else
+                    naiveProduct(matrix1, matrix2, false, false);
+            }
+            else
+            {
+                std::cout << "Matrix dot operator cannot be performed due to incompatible matrices. " << matrix1.getSizeX() << " != " << matrix2.getSizeY() << std::endl;
+            }
+        }
 
-                        (*this)[i2][i1] = sum;
-                    }
-                }
+        /**
+        Dot product
+        Reference implementation kept for checking the optimised one
+        Algorithm: Naive multiplication O(n^3)
+        */
+        void dotReference(const Matrix<T> &matrix1, const Matrix<T> &matrix2)
+        {
+            // Checking if the both matrices are compatible for multiplication
+            if (matrix1.getSizeX() == matrix2.getSizeY())
+            {
+                prepareProduct(matrix2.getSizeX(), matrix1.getSizeY(), matrix1, matrix2);
+                naiveProduct(matrix1, matrix2, false, false);
             }
             else
             {
@@ -258,24 +449,68 @@ class Matrix
         }
 
         /**
-        Transposes the matrix
+        Dot product of optionally transposed matrices
+        Produces op(matrix1) * op(matrix2), where op transposes the matrix when
+        its flag is set, without creating the transposed matrices.
+        Storage is reused the same way as in dot.
         */
-        void transpose()
+        void dot(const Matrix<T> &matrix1, const Matrix<T> &matrix2, bool transpose1, bool transpose2)
         {
-            // Create an temporary array
-            int size = sizeX * sizeY;
-            T tempArray[size];
-            for (int i = 0; i < size; i++)
-                tempArray[i] = ptr[i];
+            int rows1 = transpose1 ? matrix1.getSizeX() : matrix1.getSizeY();
+            int columns1 = transpose1 ? matrix1.getSizeY() : matrix1.getSizeX();
+            int rows2 = transpose2 ? matrix2.getSizeX() : matrix2.getSizeY();
+            int columns2 = transpose2 ? matrix2.getSizeY() : matrix2.getSizeX();
 
-            // Then simply change the layout of everything
-            for (int y = 0; y < sizeY; y++)
-                for (int x = 0; x < sizeX; x++)
-                    ptr[y * sizeY + x] = tempArray[x * sizeY + y];
+            // Checking if the both matrices are compatible for multiplication
+            if (columns1 == rows2)
+            {
+                prepareProduct(columns2, rows1, matrix1, matrix2);
+
+                if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value)
+                    gemm(transpose1, transpose2, rows1, columns2, columns1, matrix1.getArrayRef(), matrix1.getSizeY(), matrix2.getArrayRef(), matrix2.getSizeY(), ptr.get(), rows1);
+                else if constexpr (IsHalfFloat<T>::value)
+                    widenedProduct(matrix1, matrix2, transpose1, transpose2);
+                else
+                    naiveProduct(matrix1, matrix2, transpose1, transpose2);
+            }
+            else
+            {
+                std::cout << "Matrix dot operator cannot be performed due to incompatible matrices. " << columns1 << " != " << rows2 << std::endl;
+            }
+        }
 
-            // Reverse the sizes
-            sizeX = sizeY;
-            sizeY = size / sizeX;
+        /**
+        Transposes the matrix into new storage with the cache-oblivious
+        transpose of Transpose.h, e.g. switching a feature matrix between
+        featureMatrix[feature][sample] and [sample][feature], which also
+        switches the layout
+        */
+        void transpose()
+        {
+            std::shared_ptr<T[]> newArray = allocateStorage<T>((long long) sizeX * sizeY);
+            ::transpose(sizeX, sizeY, ptr.get(), sizeY, newArray.get(), sizeX);
+            ptr = std::move(newArray);
+            std::swap(sizeX, sizeY);
+            switchLayout();
+        }
+
+        /**
+        Transposes the matrix within its own storage, for matrices too large
+        to be held twice. Non-square shapes take the much slower cycle
+        following path (see Transpose.h). Storage shared with a copy or
+        adopted with setStorage is not written to, the matrix is transposed
+        into new storage instead.
+        */
+        void transposeInPlace()
+        {
+            if (!ownsStorage())
+            {
+                transpose();
+                return;
+            }
+            ::transposeInPlace(sizeX, sizeY, ptr.get());
+            std::swap(sizeX, sizeY);
+            switchLayout();
         }
 
         /**
@@ -287,7 +522,7 @@ class Matrix
                 {
                     for (int y = 0; y < sizeY; y++)
                     {
-                        ptr[x * sizeY + y] = 0;
+                        ptr[(long long) x * sizeY + y] = 0;
                     }
                 }
         }
@@ -301,14 +536,79 @@ class Matrix
             // If the size specified is valid (larger than 0
             if (size > 0)
             {
-                ptr.reset(new T[size * size]);
+                ptr = allocateStorage<T>((long long) size * size);
                 sizeX = size;
                 sizeY = size;
 
                 clear();
                 for (int i = 0; i < size; i++)
                 {
-                    ptr[i * sizeY + i] = 1;
+                    ptr[(long long) i * sizeY + i] = 1;
+                }
+            }
+        }
+
+    private:
+        /**
+        Storage this matrix may overwrite as a whole: allocated by the
+        matrix itself and not shared with a copy. A mapped file is read-only.
+        */
+        bool ownsStorage() const
+        {
+            return ptr && ptr.use_count() == 1 && ptr.get() != adoptedStorage;
+        }
+
+        void switchLayout()
+        {
+            layout = layout == SAMPLE_MAJOR ? FEATURE_MAJOR : SAMPLE_MAJOR;
+        }
+
+        template <class Expression>
+        void evaluate(const Expression &expression, T* output) const
+        {
+            long long size = (long long) expression.getSizeX() * expression.getSizeY();
+            for (long long i = 0; i < size; i++)
+                output[i] = expression[i];
+        }
+
+        /**
+        Sizes this matrix for the product of both matrices, only
+        reassigning memory when the current storage cannot be written to
+        */
+        void prepareProduct(int newSizeX, int newSizeY, const Matrix<T> &matrix1, const Matrix<T> &matrix2)
+        {
+            bool reusable = sizeX == newSizeX && sizeY == newSizeY && ownsStorage()
+                && ptr.get() != matrix1.getArrayRef() && ptr.get() != matrix2.getArrayRef();
+            if (!reusable)
+                ptr = allocateStorage<T>((long long) newSizeX * newSizeY);
+            sizeX = newSizeX;
+            sizeY = newSizeY;
+        }
+
+        /**
+        Product of 16 bit matrices computed in float, rounded once into this matrix
+        */
+        void widenedProduct(const Matrix<T> &matrix1, const Matrix<T> &matrix2, bool transpose1, bool transpose2)
+        {
+            Matrix<float> widened1(matrix1), widened2(matrix2), product;
+            product.dot(widened1, widened2, transpose1, transpose2);
+            convertElements(product.getArrayRef(), ptr.get(), product.getSize());
+        }
+
+        void naiveProduct(const Matrix<T> &matrix1, const Matrix<T> &matrix2, bool transpose1, bool transpose2)
+        {
+            int inner = transpose1 ? matrix1.getSizeY() : matrix1.getSizeX();
+
+            // Perform multiplication on both matrices
+            for (int i1 = 0; i1 < sizeY; i1++)
+            {
+                for (int i2 = 0; i2 < sizeX; i2++)
+                {
+                    T sum = 0;
+                    for (int i3 = 0; i3 < inner; i3++)
+                        sum += (transpose1 ? matrix1[i1][i3] : matrix1[i3][i1]) * (transpose2 ? matrix2[i3][i2] : matrix2[i2][i3]);
+
+                    (*this)[i2][i1] = sum;
                 }
             }
         }
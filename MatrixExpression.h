@@ -0,0 +1,156 @@
+#ifndef MATRIXEXPRESSION_H_INCLUDED
+#define MATRIXEXPRESSION_H_INCLUDED
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/**
+    Lazy elementwise arithmetic on matrices.
+
+    a + b, a - b, a * scalar and applyActivation(activation, a) do not
+    compute anything, they return small expression objects describing the
+    operation. Assigning an expression to a Matrix evaluates the whole
+    chain in a single pass over the elements, e.g. w = w - 0.1f * gradient
+    reads w and gradient once and writes w once, without temporaries.
+
+    Expressions refer to the matrices they were built from, so they are
+    meant to be assigned right away: keeping one in an auto variable past
+    the lifetime of its operands leaves it dangling.
+*/
+template <class T> class Matrix;
+
+struct MatrixExpressionTag {}; // Base of every expression type
+
+/**
+    Leaf of an expression, the elements of a matrix
+*/
+template <class T>
+struct MatrixReference : MatrixExpressionTag
+{
+    typedef T ValueType;
+    const T* data;
+    int sizeX, sizeY;
+
+    MatrixReference(const Matrix<T> &matrix) : data(matrix.getArrayRef()), sizeX(matrix.getSizeX()), sizeY(matrix.getSizeY()) {}
+
+    int getSizeX() const {return sizeX;}
+    int getSizeY() const {return sizeY;}
+    T operator [] (long long index) const {return data[index];}
+};
+
+/**
+    Operands the operators accept: matrices, taken by reference, and other
+    expressions, taken by value
+*/
+template <class X>
+struct MatrixOperand
+{
+    static constexpr bool value = std::is_base_of<MatrixExpressionTag, X>::value;
+    typedef X Type;
+};
+
+template <class T>
+struct MatrixOperand<Matrix<T>>
+{
+    static constexpr bool value = true;
+    typedef MatrixReference<T> Type;
+};
+
+struct AddOperation
+{
+    static constexpr const char* name = "addition";
+    template <class T> static T apply(T left, T right) {return left + right;}
+};
+
+struct SubtractOperation
+{
+    static constexpr const char* name = "subtraction";
+    template <class T> static T apply(T left, T right) {return left - right;}
+};
+
+template <class Operation, class Left, class Right>
+struct BinaryExpression : MatrixExpressionTag
+{
+    typedef typename Left::ValueType ValueType;
+    Left left;
+    Right right;
+
+    BinaryExpression(const Left &_left, const Right &_right) : left(_left), right(_right)
+    {
+        if (left.getSizeX() != right.getSizeX() || left.getSizeY() != right.getSizeY())
+        {
+            std::cout << "Matrix passed for " << Operation::name << " operator is of different size than expected! (" << left.getSizeX() <<  ", " << left.getSizeY() << ") != (" << right.getSizeX() <<  ", " << right.getSizeY() << ")" << std::endl;
+            throw std::invalid_argument(std::string("Matrix passed for ") + Operation::name + " operator is of different size than expected!");
+        }
+    }
+
+    int getSizeX() const {return left.getSizeX();}
+    int getSizeY() const {return left.getSizeY();}
+    ValueType operator [] (long long index) const {return Operation::apply(left[index], right[index]);}
+};
+
+template <class Expression>
+struct ScaledExpression : MatrixExpressionTag
+{
+    typedef typename Expression::ValueType ValueType;
+    Expression expression;
+    ValueType scale;
+
+    ScaledExpression(const Expression &_expression, ValueType _scale) : expression(_expression), scale(_scale) {}
+
+    int getSizeX() const {return expression.getSizeX();}
+    int getSizeY() const {return expression.getSizeY();}
+    ValueType operator [] (long long index) const {return expression[index] * scale;}
+};
+
+/**
+    Activation is one of the Activation<F, Approximate> policies of
+    Activation.h, typically the argument of a dispatchActivation body
+*/
+template <class Activation, class Expression>
+struct ActivationExpression : MatrixExpressionTag
+{
+    typedef typename Expression::ValueType ValueType;
+    Expression expression;
+
+    ActivationExpression(const Expression &_expression) : expression(_expression) {}
+
+    int getSizeX() const {return expression.getSizeX();}
+    int getSizeY() const {return expression.getSizeY();}
+    ValueType operator [] (long long index) const {return Activation::apply(expression[index]);}
+};
+
+template <class Left, class Right, class = typename std::enable_if<MatrixOperand<Left>::value && MatrixOperand<Right>::value>::type>
+BinaryExpression<AddOperation, typename MatrixOperand<Left>::Type, typename MatrixOperand<Right>::Type> operator + (const Left &left, const Right &right)
+{
+    return BinaryExpression<AddOperation, typename MatrixOperand<Left>::Type, typename MatrixOperand<Right>::Type>(left, right);
+}
+
+template <class Left, class Right, class = typename std::enable_if<MatrixOperand<Left>::value && MatrixOperand<Right>::value>::type>
+BinaryExpression<SubtractOperation, typename MatrixOperand<Left>::Type, typename MatrixOperand<Right>::Type> operator - (const Left &left, const Right &right)
+{
+    return BinaryExpression<SubtractOperation, typename MatrixOperand<Left>::Type, typename MatrixOperand<Right>::Type>(left, right);
+}
+
+template <class Operand, class Scalar, class = typename std::enable_if<MatrixOperand<Operand>::value && std::is_arithmetic<Scalar>::value>::type>
+ScaledExpression<typename MatrixOperand<Operand>::Type> operator * (const Operand &operand, Scalar scale)
+{
+    typedef typename MatrixOperand<Operand>::Type Expression;
+    return ScaledExpression<Expression>(operand, (typename Expression::ValueType) scale);
+}
+
+template <class Operand, class Scalar, class = typename std::enable_if<MatrixOperand<Operand>::value && std::is_arithmetic<Scalar>::value>::type>
+ScaledExpression<typename MatrixOperand<Operand>::Type> operator * (Scalar scale, const Operand &operand)
+{
+    return operand * scale;
+}
+
+template <class Activation, class Operand, class = typename std::enable_if<MatrixOperand<Operand>::value>::type>
+ActivationExpression<Activation, typename MatrixOperand<Operand>::Type> applyActivation(Activation, const Operand &operand)
+{
+    return ActivationExpression<Activation, typename MatrixOperand<Operand>::Type>(operand);
+}
+
+#endif // MATRIXEXPRESSION_H_INCLUDED
@@ -0,0 +1,147 @@
+#include "Network.h"
+#include <iostream>
+#include <string.h>
+
+Network::Network(int inputSize)
+{
+    this->inputSize = inputSize;
+}
+
+Network::~Network()
+{
+
+}
+
+void Network::addLayer(int outputSize, EActivationFunction activationFunction)
+{
+    int layerInputSize = layers.empty() ? inputSize : layers.back().getOutputSize();
+    layers.push_back(Layer(layerInputSize, outputSize, activationFunction));
+    outputGradients.push_back(Matrix<float>());
+}
+
+bool Network::validateInput(const char* algorithmName, Matrix<float> &featureMatrix)
+{
+    if (layers.empty())
+    {
+        std::cout << algorithmName << ": The network has no layers!" << std::endl;
+        return false;
+    }
+
+    if (featureMatrix.getFeatureCount() != inputSize)
+    {
+        std::cout << algorithmName << ": The feature dimensionality size in the feature matrix must equal to the network input size!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+Matrix<float>& Network::forward(Matrix<float> &input)
+{
+    layers[0].forward(input);
+    for (int l = 1; l < (int) layers.size(); l++)
+        layers[l].forward(layers[l - 1].outputMatrix);
+    return layers.back().outputMatrix;
+}
+
+void Network::backward(Matrix<float> &input)
+{
+    for (int l = (int) layers.size() - 1; l >= 0; l--)
+    {
+        Matrix<float> &layerInput = l == 0 ? input : layers[l - 1].outputMatrix;
+        Matrix<float> *inputGradient = l == 0 ? nullptr : &outputGradients[l - 1];
+        layers[l].backward(layerInput, outputGradients[l], inputGradient);
+    }
+}
+
+/**
+Copies samples start to start + count - 1 of the source, in either layout,
+into the feature-major destination the layers work on, resizing it only
+when the sample count differs
+*/
+void Network::copySamples(Matrix<float> &source, int start, int count, Matrix<float> &destination)
+{
+    int featureCount = source.getFeatureCount();
+    if (destination.getSizeX() != featureCount || destination.getSizeY() != count)
+        destination.setSize(featureCount, count);
+
+    if (source.getLayout() == SAMPLE_MAJOR)
+    {
+        transpose(count, featureCount, source[start], featureCount, destination.getArrayRef(), count);
+        return;
+    }
+
+    for (int k = 0; k < featureCount; k++)
+        memcpy(destination[k], source[k] + start, count * sizeof(float));
+}
+
+void Network::train(Matrix<float> &featureMatrix, Matrix<float> &targetMatrix, int epoch, float learningRate, int batchSize)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateInput("Network training", featureMatrix))
+        return;
+
+    if (targetMatrix.getFeatureCount() != layers.back().getOutputSize() || targetMatrix.getSampleCount() != featureMatrix.getSampleCount())
+    {
+        std::cout << "Network training: The target matrix must hold one value per output unit for every sample!" << std::endl;
+        return;
+    }
+
+    if (batchSize <= 0)
+    {
+        std::cout << "Network training: The batch size must be larger than 0!" << std::endl;
+        return;
+    }
+
+    /// Proceed with mini-batch back propagation
+    int sampleCount = featureMatrix.getSampleCount();
+    Matrix<float> &lossGradient = outputGradients.back();
+
+    for (int i = 0; i < epoch; i++)
+    {
+        for (int start = 0; start < sampleCount; start += batchSize)
+        {
+            int count = sampleCount - start < batchSize ? sampleCount - start : batchSize;
+            copySamples(featureMatrix, start, count, batchInput);
+            copySamples(targetMatrix, start, count, batchTarget);
+
+            Matrix<float> &output = forward(batchInput);
+
+            // Mean squared error: dL/dy = (y - t) / batch size
+            if (lossGradient.getSizeX() != output.getSizeX() || lossGradient.getSizeY() != count)
+                lossGradient.setSize(output.getSizeX(), count);
+            const float* outputs = output.getArrayRef();
+            const float* targets = batchTarget.getArrayRef();
+            float* gradient = lossGradient.getArrayRef();
+            float scale = 1.0f / count;
+            for (long long k = 0; k < output.getSize(); k++)
+                gradient[k] = (outputs[k] - targets[k]) * scale;
+
+            backward(batchInput);
+            for (Layer &layer : layers)
+                layer.update(learningRate);
+        }
+    }
+}
+
+void Network::predict(Matrix<float> &featureMatrix, Matrix<float> &outputMatrix)
+{
+    if (!validateInput("Network prediction", featureMatrix))
+        return;
+
+    // Large inputs go through in chunks so that the layer buffers stay small
+    const int chunkSize = 4096;
+    int sampleCount = featureMatrix.getSampleCount();
+    int outputSize = layers.back().getOutputSize();
+    if (outputMatrix.getSizeX() != outputSize || outputMatrix.getSizeY() != sampleCount)
+        outputMatrix.setSize(outputSize, sampleCount);
+
+    for (int start = 0; start < sampleCount; start += chunkSize)
+    {
+        int count = sampleCount - start < chunkSize ? sampleCount - start : chunkSize;
+        copySamples(featureMatrix, start, count, batchInput);
+        Matrix<float> &output = forward(batchInput);
+        for (int o = 0; o < outputSize; o++)
+            memcpy(outputMatrix[o] + start, output[o], count * sizeof(float));
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <vector>
+
+#include "Layer.h"
+
+/**
+    Multi-layer perceptron built from fully connected layers, trained
+    with mini-batch back propagation on the mean squared error.
+
+    Feature and target matrices use the Neuron layout,
+    featureMatrix[feature][sample] and targetMatrix[output][sample].
+    Every buffer of the forward and backward passes is kept between
+    batches, a training loop only allocates when the batch size changes
+    (for the last, shorter batch of an epoch).
+*/
+class Network
+{
+    public:
+        Network(int inputSize);
+        ~Network();
+
+        void addLayer(int outputSize, EActivationFunction activationFunction); // Appends a layer fed by the previous one
+        int getLayerCount() const {return (int) layers.size();}
+        Layer& getLayer(int index) {return layers[index];}
+
+        Matrix<float>& forward(Matrix<float> &input); // Returns the output of the last layer, valid until the next pass
+        void train(Matrix<float> &featureMatrix, Matrix<float> &targetMatrix, int epoch, float learningRate, int batchSize);
+        void predict(Matrix<float> &featureMatrix, Matrix<float> &outputMatrix); // outputMatrix[output][sample]
+
+    private:
+        bool validateInput(const char* algorithmName, Matrix<float> &featureMatrix);
+        void backward(Matrix<float> &input); // Back propagates the loss gradient stored for the last layer
+        static void copySamples(Matrix<float> &source, int start, int count, Matrix<float> &destination);
+
+        int inputSize;
+        std::vector<Layer> layers;
+        std::vector<Matrix<float>> outputGradients; // Gradient of the loss with respect to every layer's output
+        Matrix<float> batchInput;
+        Matrix<float> batchTarget;
+};
+
+#endif // NETWORK_H
@@ -1,14 +1,24 @@
 #include "Neuron.h"
+#include "ThreadPool.h"
+#include "SampleReader.h"
+#include "NeuronSnapshot.h"
+#include "ConvergenceMonitor.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <stdexcept>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <math.h>
 #include <iostream>
-// #include <limits>
-
-#define EULER_NUMBER 2.71828182845904523536
 
 Neuron::Neuron()
 {
     weightMatrixSet = false;
     activationFunctionEnum = HEAVISIDE;
+    approximateActivation = false;
+    updateCount = 0;
 }
 
 Neuron::~Neuron()
@@ -36,120 +46,848 @@ void Neuron::fillWeightMatrixRandomly(int featureSize, int minValue, int maxValu
     weightMatrixSet = true;
 }
 
-void Neuron::deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
+void Neuron::setWeightMatrix(const float* weights, int featureSize)
+{
+    weightMatrix.setSize(featureSize + 1, 1);
+    float* weightVector = weightMatrix.getArrayRef();
+    for (int k = 0; k < featureSize + 1; k++)
+        weightVector[k] = weights[k];
+    weightMatrixSet = true;
+}
+
+/**
+Checks that the features of the feature matrix match the weight vector,
+initialising the weight vector if it has not been set yet.
+The feature matrix may be dense, in either layout (see EDataLayout.h),
+or sparse.
+*/
+template <class FeatureMatrix>
+bool Neuron::validateFeatureCount(const char* algorithmName, const FeatureMatrix &featureMatrix)
 {
-    /// 1) Check for any missed/erroneous parameters
     // Initialise the weight vector
     if (!weightMatrixSet)
-        initWeightMatrix(featureMatrix.getSizeX());
+        initWeightMatrix(featureMatrix.getFeatureCount());
 
-    if (featureMatrix.getSizeX() != weightMatrix.getSizeX() - 1)
+    if (featureMatrix.getFeatureCount() != weightMatrix.getSizeX() - 1)
     {
-        std::cout << "Delta learning: The feature dimensionality size in the feature matrix must equal to the weight matrix size!" << std::endl;
-        return;
+        std::cout << algorithmName << ": The feature dimensionality size in the feature matrix must equal to the weight matrix size!" << std::endl;
+        return false;
     }
 
-    if (featureMatrix.getSizeX() <= 0)
+    if (featureMatrix.getFeatureCount() <= 0)
     {
-        std::cout << "Delta learning: The feature dimension must be larger than 0 for learning to occur!" << std::endl;
-        return;
+        std::cout << algorithmName << ": The feature dimension must be larger than 0 for learning to occur!" << std::endl;
+        return false;
     }
 
-    if (featureMatrix.getSizeY() != classificationVector.size())
+    return true;
+}
+
+/**
+Checks that the feature matrix and the classification vector can be
+learnt from, see validateFeatureCount
+*/
+template <class FeatureMatrix>
+bool Neuron::validateLearningData(const char* algorithmName, const FeatureMatrix &featureMatrix, const Array<float> &classificationVector)
+{
+    if (!validateFeatureCount(algorithmName, featureMatrix))
+        return false;
+
+    if (featureMatrix.getSampleCount() != classificationVector.size())
     {
-        std::cout << "Delta learning: The number of samples in the feature matrix must equal to the classification vector size!" << std::endl;
-        return;
+        std::cout << algorithmName << ": The number of samples in the feature matrix must equal to the classification vector size!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+Statistics gathered by deltaLearningPass from every target and the
+response it got: none for plain learning, the error count and the loss
+for a convergence monitor. Inlined, so plain learning pays nothing.
+*/
+struct NoSampleStatistics
+{
+    void addSample(float, float) {}
+};
+
+struct EpochErrorStatistics
+{
+    int errorCount = 0;
+    double loss = 0;
+
+    void addSample(float target, float response)
+    {
+        float error = target - response;
+        errorCount += fabsf(error) >= 0.5f;
+        loss += 0.5 * error * error;
     }
+};
+
+/**
+Validation and setup shared by the delta learning overloads over a float
+feature matrix. Calls epochBody(learnSamples, i) for the epochs i = 0 to
+epoch - 1, stopping early once it returns false, where
+learnSamples(start, count, statistics) is a deltaLearningPass over the
+count samples from sample start on.
+*/
+template <class EpochBody>
+void Neuron::learnDeltaEpochs(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, EpochBody epochBody)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Delta learning", featureMatrix, classificationVector))
+        return;
 
     /// Proceed with the delta learning algorithm
-    int featureDimension = featureMatrix.getSizeX();
+    int featureDimension = featureMatrix.getFeatureCount();
+    long long featureStride = featureMatrix.getFeatureStride();
+    long long sampleStride = featureMatrix.getSampleStride();
 
     // Create the augmented data sample matrix (vector)
     Matrix<float> augmentedDataSample(1, featureDimension + 1); // Taken outside the loop to speed things up
     augmentedDataSample[0][0] = 1; // This value is always 1
 
-    // For randomising the access function for Stochastic learning
-//    std::vector<int> accessOrder;
+    // Work on the raw storage so that the loop below never allocates
+    float* sample = augmentedDataSample.getArrayRef();
+    const float* features = featureMatrix.getArrayRef();
+    const float* targets = classificationVector.getArray();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        auto learnSamples = [&](int start, int count, auto &statistics)
+        {
+            deltaLearningPass(activation, features + start * sampleStride, featureStride, sampleStride, targets + start, count, sample, learningRate, statistics);
+        };
+
+        // Loop the delta learning rule epoch times
+        for (int i = 0; i < epoch; i++)
+            if (!epochBody(learnSamples, i))
+                break;
+    });
+}
+
+void Neuron::deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
+{
+    int sampleCount = featureMatrix.getSampleCount();
+    learnDeltaEpochs(featureMatrix, classificationVector, epoch, learningRate, [&](auto &learnSamples, int)
+    {
+        NoSampleStatistics statistics;
+        learnSamples(0, sampleCount, statistics);
+        return true;
+    });
+}
+
+/**
+Delta learning for at most epoch epochs, stopping after the first epoch
+in which the monitor sees convergence (see ConvergenceMonitor.h).
+The error count and loss are gathered during the pass, the weight change
+from a copy of the weights taken before it, so there is no separate
+scoring pass. The epochs run learn the same weights as deltaLearning.
+*/
+void Neuron::deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, ConvergenceMonitor &monitor)
+{
+    int sampleCount = featureMatrix.getSampleCount();
+    Matrix<float> previousWeights;
+    monitor.reset();
 
-    // Loop the delta learning rule epoch times
-    for (int i = 0; i < epoch; i++)
+    learnDeltaEpochs(featureMatrix, classificationVector, epoch, learningRate, [&](auto &learnSamples, int i)
     {
-        // Add all entries to it
-//        for (int i = 0; i < classificationVector.size(); i++)
-//            accessOrder.push_back(i);
+        // The weights may only have been initialised by learnDeltaEpochs
+        int weightSize = weightMatrix.getSizeX();
+        if (previousWeights.getSizeX() != weightSize)
+            previousWeights.setSize(weightSize, 1);
+        float* previous = previousWeights.getArrayRef();
+        const float* weights = weightMatrix.getArrayRef();
+        for (int k = 0; k < weightSize; k++)
+            previous[k] = weights[k];
 
-        // Loop through every single data sample
-        for (int j = 0; j < classificationVector.size(); j++)
+        EpochErrorStatistics statistics;
+        learnSamples(0, sampleCount, statistics);
+
+        double squaredDelta = 0;
+        for (int k = 0; k < weightSize; k++)
+            squaredDelta += (double) (weights[k] - previous[k]) * (weights[k] - previous[k]);
+
+        EpochStatistics epochStatistics;
+        epochStatistics.epoch = i + 1;
+        epochStatistics.sampleCount = sampleCount;
+        epochStatistics.errorCount = statistics.errorCount;
+        epochStatistics.loss = sampleCount > 0 ? (float) (statistics.loss / sampleCount) : 0;
+        epochStatistics.weightDeltaNorm = (float) sqrt(squaredDelta);
+        return !monitor.endEpoch(epochStatistics);
+    });
+}
+
+/**
+Delta learning that keeps the weights served through the publisher
+(see NeuronSnapshot.h) up to date while it runs: the samples are learnt
+in runs of publishInterval and the weights are published after every
+run. The weights learnt are the same as without publishing.
+*/
+void Neuron::deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, NeuronPublisher &publisher, int publishInterval)
+{
+    if (publishInterval <= 0)
+    {
+        std::cout << "Delta learning: The publish interval must be larger than 0!" << std::endl;
+        return;
+    }
+
+    int sampleCount = featureMatrix.getSampleCount();
+    learnDeltaEpochs(featureMatrix, classificationVector, epoch, learningRate, [&](auto &learnSamples, int)
+    {
+        NoSampleStatistics statistics;
+        for (int start = 0; start < sampleCount; start += publishInterval)
+        {
+            learnSamples(start, sampleCount - start < publishInterval ? sampleCount - start : publishInterval, statistics);
+            publisher.publish(*this);
+        }
+        return true;
+    });
+}
+
+/**
+One pass of the delta learning rule over sampleCount samples, feature k of
+sample j being features[k * featureStride + j * sampleStride].
+augmentedDataSample holds weightSize values and starts with the constant 1.
+Contiguous samples (sample-major) are read in place rather than gathered,
+both ways do the same arithmetic in the same order.
+*/
+template <class ActivationPolicy>
+void Neuron::deltaLearningPass(ActivationPolicy activation, const float* features, long long featureStride, long long sampleStride, const float* targets, int sampleCount, float* augmentedDataSample, float learningRate)
+{
+    NoSampleStatistics statistics;
+    deltaLearningPass(activation, features, featureStride, sampleStride, targets, sampleCount, augmentedDataSample, learningRate, statistics);
+}
+
+/**
+Same, adding the target and response of every sample to statistics
+*/
+template <class ActivationPolicy, class SampleStatistics>
+void Neuron::deltaLearningPass(ActivationPolicy activation, const float* features, long long featureStride, long long sampleStride, const float* targets, int sampleCount, float* augmentedDataSample, float learningRate, SampleStatistics &statistics)
+{
+    int weightSize = weightMatrix.getSizeX();
+    int featureDimension = weightSize - 1;
+    float* weights = weightMatrix.getArrayRef();
+
+    // Loop through every single data sample
+    for (int j = 0; j < sampleCount; j++)
+    {
+        const float* sample = features + j * sampleStride;
+        if (featureStride != 1)
         {
             // Set the data for the augmented sample matrix (vector)
             for (int k = 0; k < featureDimension; k++)
-                augmentedDataSample[0][k + 1] = featureMatrix[k][j];
+                augmentedDataSample[k + 1] = sample[k * featureStride];
+            sample = augmentedDataSample + 1;
+        }
 
-            // Calculate the neuron response
-            Matrix<float> resultMatrix;
-            resultMatrix.dot(weightMatrix, augmentedDataSample);
-            float response = activationFunction(resultMatrix[0][0]); // The result matrix should be of size(1, 1)
+        // Calculate the neuron response, the augmented feature is always 1
+        float response = activation.apply(weights[0] + netInput(weights + 1, sample, featureDimension));
 
-//            std::cout << "DELTA RULE LEARNING: Predicted " << resultMatrix[0][0] << " -> " << response << ", aim = " << classificationVector[0] << std::endl;
+//        std::cout << "DELTA RULE LEARNING: Predicted " << weights[0] + netInput(weights + 1, sample, featureDimension) << " -> " << response << ", aim = " << targets[j] << std::endl;
+        statistics.addSample(targets[j], response);
 
-            // Update the weight with Delta update rule: w = w + n(t - y)x
-            float factor = learningRate * (classificationVector[j] - response); // n(t - y)
-            for (int k = 0; k < weightMatrix.getSizeX(); k++)
-                weightMatrix[k][0] = weightMatrix[k][0] + factor * augmentedDataSample[0][k];
-        }
+        // Update the weight with Delta update rule: w = w + n(t - y)x
+        float factor = learningRate * (targets[j] - response); // n(t - y)
+        weights[0] = weights[0] + factor;
+        float* featureWeights = weights + 1;
+        for (int k = 0; k < featureDimension; k++)
+            featureWeights[k] = featureWeights[k] + factor * sample[k];
     }
 }
 
-void Neuron::hebbianLearning(Matrix<float> &featureMatrix, int epoch, float learningRate)
+/**
+Widens samples start to start + count - 1 of a 16 bit feature matrix into
+block, keeping the layout. block must be sized for at least count samples
+in that layout and is addressed through its strides.
+*/
+template <class T>
+static void widenSamples(const Matrix<T> &featureMatrix, int start, int count, Matrix<float> &block)
+{
+    if (featureMatrix.getLayout() == SAMPLE_MAJOR)
+    {
+        convertElements(featureMatrix[start], block.getArrayRef(), (long long) count * featureMatrix.getFeatureCount());
+        return;
+    }
+
+    for (int k = 0; k < featureMatrix.getFeatureCount(); k++)
+        convertElements(featureMatrix[k] + start, block[k], count);
+}
+
+/**
+Buffer for widenSamples holding blockSize samples of the feature matrix,
+in its layout
+*/
+template <class T>
+static void sizeWideningBlock(const Matrix<T> &featureMatrix, int blockSize, Matrix<float> &block)
+{
+    if (featureMatrix.getLayout() == SAMPLE_MAJOR)
+        block.setSize(blockSize, featureMatrix.getFeatureCount());
+    else
+        block.setSize(featureMatrix.getFeatureCount(), blockSize);
+    block.setLayout(featureMatrix.getLayout());
+}
+
+/**
+Samples per widened block, about 256 KB of floats so that a block is
+still in cache when it is learnt from
+*/
+static int wideningBlockSize(int featureDimension, int sampleCount)
+{
+    int blockSize = 65536 / featureDimension;
+    if (blockSize < 16)
+        blockSize = 16;
+    return blockSize < sampleCount ? blockSize : sampleCount;
+}
+
+void Neuron::deltaLearning(Matrix<Half> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
+{
+    widenedDeltaLearning(featureMatrix, classificationVector, epoch, learningRate);
+}
+
+void Neuron::deltaLearning(Matrix<BFloat16> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
+{
+    widenedDeltaLearning(featureMatrix, classificationVector, epoch, learningRate);
+}
+
+/**
+Delta learning over 16 bit features (see HalfFloat.h). Blocks of samples
+are widened to float just before they are learnt from, so only the 16 bit
+matrix stays resident and every sum is a float one. The samples go
+through deltaLearningPass in the same order, the weights are exactly
+those deltaLearning learns from the widened matrix.
+*/
+template <class T>
+void Neuron::widenedDeltaLearning(Matrix<T> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Delta learning", featureMatrix, classificationVector))
+        return;
+
+    /// Proceed with the delta learning algorithm
+    int featureDimension = featureMatrix.getFeatureCount();
+    int sampleCount = featureMatrix.getSampleCount();
+    int blockSize = wideningBlockSize(featureDimension, sampleCount);
+    Matrix<float> block;
+    sizeWideningBlock(featureMatrix, blockSize, block);
+
+    // Create the augmented data sample matrix (vector)
+    Matrix<float> augmentedDataSample(1, featureDimension + 1);
+    augmentedDataSample[0][0] = 1; // This value is always 1
+    float* sample = augmentedDataSample.getArrayRef();
+    const float* targets = classificationVector.getArray();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        for (int i = 0; i < epoch; i++)
+        {
+            for (int start = 0; start < sampleCount; start += blockSize)
+            {
+                int count = sampleCount - start < blockSize ? sampleCount - start : blockSize;
+                widenSamples(featureMatrix, start, count, block);
+                deltaLearningPass(activation, block.getArrayRef(), block.getFeatureStride(), block.getSampleStride(), targets + start, count, sample, learningRate);
+            }
+        }
+    });
+}
+
+/**
+Delta learning over a sparse feature matrix. Only the weights of the
+non-zero features of a sample take part in its net input and are
+updated, which is still the rule of the dense deltaLearning since
+w = w + n(t - y)x leaves the weights of zero features as they are.
+An epoch costs O(non-zeros) rather than O(features * samples).
+*/
+void Neuron::deltaLearning(SparseMatrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate)
 {
     /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Sparse delta learning", featureMatrix, classificationVector))
+        return;
+
+    /// Proceed with the delta learning algorithm
+    int sampleCount = featureMatrix.getSampleCount();
+    float* weights = weightMatrix.getArrayRef();
+    const float* targets = classificationVector.getArray();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        // Loop the delta learning rule epoch times
+        for (int i = 0; i < epoch; i++)
+        {
+            for (int j = 0; j < sampleCount; j++)
+            {
+                const int* indices = featureMatrix.getSampleIndices(j);
+                const float* values = featureMatrix.getSampleValues(j);
+                int count = featureMatrix.getSampleNonZeroCount(j);
+
+                // Calculate the neuron response
+                float response = activation.apply(sparseNetInput(weights, indices, values, count));
+
+                // Update the weight with Delta update rule: w = w + n(t - y)x, only where x is not zero
+                float factor = learningRate * (targets[j] - response); // n(t - y)
+                weights[0] = weights[0] + factor; // The augmented feature is always 1
+                for (int n = 0; n < count; n++)
+                    weights[indices[n] + 1] += factor * values[n];
+            }
+        }
+    });
+}
+
+/**
+Delta learning over a data set that is pulled from the reader chunk by chunk.
+A background thread reads the next chunk into the second of two chunk
+buffers while the current one is learnt from, so no more than two chunks
+are ever held in memory. The samples are visited in the same order as
+deltaLearning would, which it therefore reproduces exactly.
+*/
+void Neuron::streamingLearning(SampleReader &reader, int epoch, float learningRate, int chunkSize)
+{
+    /// 1) Check for any missed/erroneous parameters
+    int featureDimension = reader.getDimensionality();
+    if (!weightMatrixSet)
+        initWeightMatrix(featureDimension);
+
+    if (featureDimension != weightMatrix.getSizeX() - 1)
+    {
+        std::cout << "Streaming learning: The feature dimensionality of the reader must equal to the weight matrix size!" << std::endl;
+        return;
+    }
+
+    if (featureDimension <= 0)
+    {
+        std::cout << "Streaming learning: The feature dimension must be larger than 0 for learning to occur!" << std::endl;
+        return;
+    }
+
+    if (chunkSize <= 0)
+    {
+        std::cout << "Streaming learning: The chunk size must be larger than 0!" << std::endl;
+        return;
+    }
+
+    /// 2) Two chunk buffers, handed back and forth between the reader thread and this one
+    Matrix<float> featureChunks[2] = {Matrix<float>(featureDimension, chunkSize), Matrix<float>(featureDimension, chunkSize)};
+    Array<float> classificationChunks[2] = {Array<float>(chunkSize), Array<float>(chunkSize)};
+    int chunkCounts[2] = {0, 0};
+    bool chunkFilled[2] = {false, false};
+    std::mutex mutex;
+    std::condition_variable chunkChanged;
+
+    // Every epoch ends with an empty chunk, a failed read ends the whole stream
+    std::thread readAhead([&]()
+    {
+        int slot = 0;
+        for (int i = 0; i < epoch; i++)
+        {
+            reader.rewind();
+            int count;
+            do
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    chunkChanged.wait(lock, [&]{return !chunkFilled[slot];});
+                }
+                count = reader.read(featureChunks[slot], classificationChunks[slot]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    chunkCounts[slot] = count;
+                    chunkFilled[slot] = true;
+                }
+                chunkChanged.notify_all();
+                slot ^= 1;
+            } while (count > 0);
+
+            if (count < 0)
+                return;
+        }
+    });
+
+    /// 3) Learn from the chunks as they arrive
+    Matrix<float> augmentedDataSample(1, featureDimension + 1);
+    augmentedDataSample[0][0] = 1; // This value is always 1
+    float* sample = augmentedDataSample.getArrayRef();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        int slot = 0;
+        for (int i = 0; i < epoch; i++)
+        {
+            int count;
+            do
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    chunkChanged.wait(lock, [&]{return chunkFilled[slot];});
+                    count = chunkCounts[slot];
+                }
+
+                if (count > 0)
+                    deltaLearningPass(activation, featureChunks[slot].getArrayRef(), chunkSize, 1, classificationChunks[slot].getArray(), count, sample, learningRate);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    chunkFilled[slot] = false;
+                }
+                chunkChanged.notify_all();
+                slot ^= 1;
+            } while (count > 0);
+
+            if (count < 0)
+            {
+                std::cout << "Streaming learning: Reading the samples failed!" << std::endl;
+                break;
+            }
+        }
+    });
+
+    readAhead.join();
+}
+
+/**
+One online update of the delta rule, w = w + n(t - y)x, from features
+stored contiguously, e.g. an event as it arrives. The rate n is taken
+from the learning rate schedule at the current update count, which then
+advances. Learning continues from the current weights (warm start), they
+are only initialised if no weights have been set yet. Nothing is
+allocated and no data set has to be built; with a constant rate, feeding
+the samples of a data set one by one learns exactly what one epoch of
+deltaLearning learns.
+*/
+void Neuron::partialFit(const float* features, int featureCount, float target)
+{
+    partialFitBatch(features, featureCount, &target, 1);
+}
+
+/**
+partialFit for sampleCount samples in a row, sample j starting at
+features + j * featureCount, with a single activation function dispatch
+*/
+void Neuron::partialFitBatch(const float* features, int featureCount, const float* targets, int sampleCount)
+{
+    if (featureCount <= 0)
+    {
+        std::cout << "Online learning: The feature dimension must be larger than 0 for learning to occur!" << std::endl;
+        return;
+    }
+
     // Initialise the weight vector
     if (!weightMatrixSet)
-        initWeightMatrix(featureMatrix.getSizeX());
+        initWeightMatrix(featureCount);
 
-    if (featureMatrix.getSizeX() != weightMatrix.getSizeX() - 1)
+    if (weightMatrix.getSizeX() != featureCount + 1) // +1 because the weight matrix is augmented
     {
-        std::cout << "Hebbian learning: The feature dimensionality size in the feature matrix must equal to the weight matrix size!" << std::endl;
+        std::cout << "Online learning: Got " << featureCount << " features, the weight matrix expects " << weightMatrix.getSizeX() - 1 << "!" << std::endl;
         return;
     }
 
-    if (featureMatrix.getSizeX() <= 0)
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
     {
-        std::cout << "Hebbian learning: The feature dimension must be larger than 0 for learning to occur!" << std::endl;
+        for (int j = 0; j < sampleCount; j++)
+            partialFitSample(activation, features + (long long) j * featureCount, featureCount, targets[j]);
+    });
+}
+
+template <class ActivationPolicy>
+void Neuron::partialFitSample(ActivationPolicy activation, const float* features, int featureCount, float target)
+{
+    float* weights = weightMatrix.getArrayRef();
+
+    // Calculate the neuron response, the augmented feature is always 1
+    float response = activation.apply(weights[0] + netInput(weights + 1, features, featureCount));
+
+    // Update the weight with Delta update rule: w = w + n(t - y)x
+    float factor = learningRateSchedule.rate(updateCount) * (target - response); // n(t - y)
+    updateCount++;
+    weights[0] = weights[0] + factor;
+    float* featureWeights = weights + 1;
+    for (int k = 0; k < featureCount; k++)
+        featureWeights[k] = featureWeights[k] + factor * features[k];
+}
+
+/**
+Mini-batch delta learning spread over a pool of threads.
+Every batch is split into one fixed, contiguous slice of samples per
+thread. Each thread sums the delta rule updates n / B * (t - y)x of its slice
+into its own gradient buffer using the weights from before the batch.
+The buffers are then combined with a pairwise tree reduction whose order
+only depends on the thread count, each thread reducing and applying its
+own range of weights, so the result is bit-reproducible for a given
+batch size and thread count.
+w = w + n / B * sum((t - y)x), which equals deltaLearning for B = 1.
+*/
+void Neuron::miniBatchLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int batchSize, int threadCount)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Mini-batch learning", featureMatrix, classificationVector))
+        return;
+
+    if (batchSize <= 0)
+    {
+        std::cout << "Mini-batch learning: The batch size must be larger than 0!" << std::endl;
         return;
     }
 
+    /// Proceed with the mini-batch delta learning algorithm
+    int featureDimension = featureMatrix.getFeatureCount();
+    int sampleCount = featureMatrix.getSampleCount();
+    long long featureStride = featureMatrix.getFeatureStride();
+    long long sampleStride = featureMatrix.getSampleStride();
+    int weightSize = weightMatrix.getSizeX();
+    if (threadCount > batchSize)
+        threadCount = batchSize;
+    ThreadPool threadPool(threadCount);
+    threadCount = threadPool.getThreadCount();
+
+    // One gradient and one augmented sample buffer per thread, padded to whole cache lines against false sharing
+    int bufferStride = (weightSize + 15) / 16 * 16;
+    Matrix<float> gradients(threadCount, bufferStride);
+    Matrix<float> augmentedDataSamples(threadCount, bufferStride);
+    for (int t = 0; t < threadCount; t++)
+        augmentedDataSamples[t][0] = 1; // This value is always 1
+
+    float* weights = weightMatrix.getArrayRef();
+    const float* features = featureMatrix.getArrayRef();
+    const float* targets = classificationVector.getArray();
+    int batchStart = 0;
+    int batchEnd = 0;
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        // Phase 1: every thread sums the updates of its slice of the batch
+        auto accumulate = [&](int thread)
+        {
+            int batchLength = batchEnd - batchStart;
+            int sliceStart = batchStart + (int) ((long long) batchLength * thread / threadCount);
+            int sliceEnd = batchStart + (int) ((long long) batchLength * (thread + 1) / threadCount);
+            float* gradient = gradients[thread];
+            float* sample = augmentedDataSamples[thread];
+
+            for (int k = 0; k < weightSize; k++)
+                gradient[k] = 0;
+
+            for (int j = sliceStart; j < sliceEnd; j++)
+            {
+                const float* dataSample = features + j * sampleStride;
+                for (int k = 0; k < featureDimension; k++)
+                    sample[k + 1] = dataSample[k * featureStride];
+
+                float factor = learningRate / batchLength * (targets[j] - activation.apply(weights[0] + netInput(weights + 1, sample + 1, featureDimension))); // n / B * (t - y)
+                for (int k = 0; k < weightSize; k++)
+                    gradient[k] += factor * sample[k];
+            }
+        };
+
+        // Phase 2: every thread tree-reduces and applies its own range of weights
+        auto reduceAndUpdate = [&](int thread)
+        {
+            int weightStart = (int) ((long long) weightSize * thread / threadCount);
+            int weightEnd = (int) ((long long) weightSize * (thread + 1) / threadCount);
+            for (int stride = 1; stride < threadCount; stride *= 2)
+                for (int t = 0; t + stride < threadCount; t += 2 * stride)
+                {
+                    float* destination = gradients[t];
+                    const float* source = gradients[t + stride];
+                    for (int k = weightStart; k < weightEnd; k++)
+                        destination[k] += source[k];
+                }
+
+            const float* gradient = gradients[0];
+            for (int k = weightStart; k < weightEnd; k++)
+                weights[k] = weights[k] + gradient[k];
+        };
+
+        // Loop the mini-batch learning rule epoch times
+        for (int i = 0; i < epoch; i++)
+        {
+            for (batchStart = 0; batchStart < sampleCount; batchStart += batchSize)
+            {
+                batchEnd = sampleCount - batchStart < batchSize ? sampleCount : batchStart + batchSize;
+                threadPool.run(accumulate);
+                threadPool.run(reduceAndUpdate);
+            }
+        }
+    });
+}
+
+/**
+Asynchronous (Hogwild style) delta learning for sparse features.
+The non-zeros of the samples are gathered once into a sparse feature
+matrix, see the sparse asynchronousLearning, rather than by a scan of
+every feature of every sample in every epoch.
+*/
+void Neuron::asynchronousLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int threadCount)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Asynchronous learning", featureMatrix, classificationVector))
+        return;
+
+    SparseMatrix<float> sparseFeatureMatrix(featureMatrix);
+    asynchronousLearning(sparseFeatureMatrix, classificationVector, epoch, learningRate, threadCount);
+}
+
+/**
+Every thread streams its own contiguous shard of the samples for all
+epochs, without any barrier, and applies w = w + n(t - y)x straight to
+one shared weight vector through relaxed atomic loads and stores.
+Concurrent updates of the same weight may overwrite each other, which
+costs little when the features are sparse since only the bias and the
+weights of the non-zero features are read and written: an update costs
+O(non-zeros) rather than O(features).
+*/
+void Neuron::asynchronousLearning(SparseMatrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int threadCount)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateLearningData("Asynchronous learning", featureMatrix, classificationVector))
+        return;
+
+    /// Proceed with the asynchronous delta learning algorithm
+    int sampleCount = featureMatrix.getSampleCount();
+    int weightSize = weightMatrix.getSizeX();
+    if (threadCount > sampleCount)
+        threadCount = sampleCount;
+    ThreadPool threadPool(threadCount);
+    threadCount = threadPool.getThreadCount();
+
+    // Shared weights, relaxed atomics are plain loads and stores on common hardware
+    std::unique_ptr<std::atomic<float>[]> sharedWeights(new std::atomic<float>[weightSize]);
+    for (int k = 0; k < weightSize; k++)
+        sharedWeights[k].store(weightMatrix[k][0], std::memory_order_relaxed);
+
+    const float* targets = classificationVector.getArray();
+    std::atomic<float>* featureWeights = sharedWeights.get() + 1; // Weight of feature k, the bias comes first
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        auto learnShard = [&](int thread)
+        {
+            int shardStart = (int) ((long long) sampleCount * thread / threadCount);
+            int shardEnd = (int) ((long long) sampleCount * (thread + 1) / threadCount);
+
+            for (int i = 0; i < epoch; i++)
+            {
+                for (int j = shardStart; j < shardEnd; j++)
+                {
+                    const int* indices = featureMatrix.getSampleIndices(j);
+                    const float* values = featureMatrix.getSampleValues(j);
+                    int count = featureMatrix.getSampleNonZeroCount(j);
+
+                    // Calculate the net input against the current shared weights, the augmented feature is always 1
+                    float sum = sharedWeights[0].load(std::memory_order_relaxed);
+                    for (int n = 0; n < count; n++)
+                        sum += featureWeights[indices[n]].load(std::memory_order_relaxed) * values[n];
+
+                    // Update the weight with Delta update rule: w = w + n(t - y)x, only where x is not zero
+                    float factor = learningRate * (targets[j] - activation.apply(sum)); // n(t - y)
+                    if (factor == 0)
+                        continue;
+                    sharedWeights[0].store(sharedWeights[0].load(std::memory_order_relaxed) + factor, std::memory_order_relaxed);
+                    for (int n = 0; n < count; n++)
+                    {
+                        std::atomic<float> &weight = featureWeights[indices[n]];
+                        weight.store(weight.load(std::memory_order_relaxed) + factor * values[n], std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+        threadPool.run(learnShard);
+    });
+
+    for (int k = 0; k < weightSize; k++)
+        weightMatrix[k][0] = sharedWeights[k].load(std::memory_order_relaxed);
+}
+
+void Neuron::hebbianLearning(Matrix<float> &featureMatrix, int epoch, float learningRate)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateFeatureCount("Hebbian learning", featureMatrix))
+        return;
+
     /// Proceed with the delta learning algorithm
-    int featureDimension = featureMatrix.getSizeX();
+    int featureDimension = featureMatrix.getFeatureCount();
+    int sampleCount = featureMatrix.getSampleCount();
+    long long featureStride = featureMatrix.getFeatureStride();
+    long long sampleStride = featureMatrix.getSampleStride();
+    int weightSize = weightMatrix.getSizeX();
 
     // Create the augmented data sample matrix (vector)
     Matrix<float> augmentedDataSample(1, featureDimension + 1); // Taken outside the loop to speed things up
     augmentedDataSample[0][0] = 1; // This value is always 1
 
-    // Loop the delta learning rule epoch times
-    for (int i = 0; i < epoch; i++)
+    // Work on the raw storage so that the loop below never allocates
+    float* sample = augmentedDataSample.getArrayRef();
+    float* weights = weightMatrix.getArrayRef();
+    const float* features = featureMatrix.getArrayRef();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
     {
-        // Loop through every single data sample
-        for (int j = 0; j < featureMatrix.getSizeY(); j++)
+        // Loop the delta learning rule epoch times
+        for (int i = 0; i < epoch; i++)
         {
-            // Set the data for the augmented sample matrix (vector)
-            for (int k = 0; k < featureDimension; k++)
-                augmentedDataSample[0][k + 1] = featureMatrix[k][j];
+            // Loop through every single data sample
+            for (int j = 0; j < sampleCount; j++)
+            {
+                // Set the data for the augmented sample matrix (vector)
+                const float* dataSample = features + j * sampleStride;
+                for (int k = 0; k < featureDimension; k++)
+                    sample[k + 1] = dataSample[k * featureStride];
 
-            // Calculate the neuron response
-            Matrix<float> resultMatrix;
-            resultMatrix.dot(weightMatrix, augmentedDataSample);
-            float response = activationFunction(resultMatrix[0][0]); // The result matrix should be of size(1, 1)
+                // Calculate the neuron response, the augmented feature is always 1
+                float response = activation.apply(weights[0] + netInput(weights + 1, sample + 1, featureDimension));
 
-            // Update the weight with Delta update rule: w = w + nyx
-            float factor = learningRate * response; // ny
-            for (int k = 0; k < weightMatrix.getSizeX(); k++)
-                weightMatrix[k][0] = weightMatrix[k][0] + factor * augmentedDataSample[0][k];
+                // Update the weight with Delta update rule: w = w + nyx
+                float factor = learningRate * response; // ny
+                for (int k = 0; k < weightSize; k++)
+                    weights[k] = weights[k] + factor * sample[k];
+            }
         }
-    }
+    });
+}
+
+/**
+Hebbian learning over a sparse feature matrix, see the sparse deltaLearning
+*/
+void Neuron::hebbianLearning(SparseMatrix<float> &featureMatrix, int epoch, float learningRate)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateFeatureCount("Sparse hebbian learning", featureMatrix))
+        return;
+
+    /// Proceed with the hebbian learning algorithm
+    int sampleCount = featureMatrix.getSampleCount();
+    float* weights = weightMatrix.getArrayRef();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        for (int i = 0; i < epoch; i++)
+        {
+            for (int j = 0; j < sampleCount; j++)
+            {
+                const int* indices = featureMatrix.getSampleIndices(j);
+                const float* values = featureMatrix.getSampleValues(j);
+                int count = featureMatrix.getSampleNonZeroCount(j);
+
+                // Update the weight with Hebbian update rule: w = w + nyx, only where x is not zero
+                float factor = learningRate * activation.apply(sparseNetInput(weights, indices, values, count)); // ny
+                weights[0] = weights[0] + factor;
+                for (int n = 0; n < count; n++)
+                    weights[indices[n] + 1] += factor * values[n];
+            }
+        }
+    });
 }
 
 float Neuron::predict(Matrix<float>& dataPoint)
+{
+    return predict(dataPoint.view());
+}
+
+/**
+The data point is read where it is, feature k at dataPoint[k][0], so
+scoring a sample of a feature matrix through subMatrixView copies and
+allocates nothing
+*/
+float Neuron::predict(const MatrixView<const float>& dataPoint)
 {
     if (!weightMatrixSet)
         initWeightMatrix(dataPoint.getSizeX());
@@ -160,116 +898,257 @@ float Neuron::predict(Matrix<float>& dataPoint)
         return -1;
     }
 
-    // Calculate the neuron response
-    Matrix<float> dataMatrix; // Augment the data point
-    getAugmentedDataSample(dataPoint, dataMatrix);
-    Matrix<float> resultMatrix; // Create the result matrix to store the multiplied result
-    resultMatrix.dot(weightMatrix, dataMatrix);
-    lastNetInput = resultMatrix[0][0];
-    return activationFunction(resultMatrix[0][0]);
+    // Calculate the neuron response, the augmented entry of the data point being 1
+    const float* weights = weightMatrix.getArrayRef();
+    float sum = weights[0];
+    for (int k = 0; k < dataPoint.getSizeX(); k++)
+        sum += weights[k + 1] * dataPoint[k][0];
+    lastNetInput = sum;
+    return activationFunction(sum);
 }
 
-float Neuron::activationFunction(float input)
+/**
+Predicts the classification of one data point whose features are stored
+contiguously, e.g. a request buffer or a sample of a sample-major matrix.
+Nothing is written: the weights are not initialised here, lastNetInput
+is left untouched and nothing is allocated, so any number of threads may
+score with the same trained neuron concurrently. Returns -1 if the
+weights are not set or do not match featureCount.
+*/
+float Neuron::predict(const float* features, int featureCount) const
 {
-    switch (activationFunctionEnum)
+    if (!weightMatrixSet || weightMatrix.getSizeX() != featureCount + 1) // +1 because the weight matrix is augmented
     {
-        case LINEAR:
-			return input;
-
-		case HEAVISIDE: // 0 to 1
-			if (input > 0) return 1;
-			else if (input == 0) return 0.5f;
-			else return 0;
-
-		case LOGISTIC: // From 0 to 1
-			return 1.0f / (1.0f + (float) pow(EULER_NUMBER, -input));
-
-        case SOFTMAX:
-            return 0;
+        std::cout << "Incorrect number of feature dimension entered for data point. Got " << featureCount << ". Expected " << (weightMatrixSet ? weightMatrix.getSizeX() - 1 : 0) << std::endl;
+        return -1;
+    }
 
-		case TANH: // From -1 to 1
-			return tanh(input);
+    const float* weights = weightMatrix.getArrayRef();
+    float sum = weights[0] + netInput(weights + 1, features, featureCount); // The augmented feature is always 1
+    float output = sum;
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        output = activation.apply(sum);
+    });
+    return output;
+}
 
-		case TANH01: // From 0 to 1
-			return tanh(input) / 2.0f + 0.5f;
+/**
+Scores every sample of the feature matrix in one pass.
+In a feature-major matrix, featureMatrix[feature][sample], instead of
+gathering one sample at a time the net inputs of a block of samples are
+accumulated feature by feature, which is a contiguous, vectorisable
+sweep. The bias is the starting value of every net input. In a
+sample-major matrix every sample already is contiguous and its net input
+is a single dot product.
+output must hold featureMatrix.getSampleCount() values.
+*/
+void Neuron::predictBatch(const Matrix<float>& featureMatrix, float* output)
+{
+    if (!validateBatchFeatureCount(featureMatrix.getFeatureCount()))
+        return;
 
-        case RECTIFIED_LINEAR_UNIT:
-            if (input < 0) return 0;
-            return input;
+    predictSamples(featureMatrix.getArrayRef(), featureMatrix.getFeatureStride(), featureMatrix.getSampleStride(), featureMatrix.getSampleCount(), output);
+}
 
-		case ARCTAN: // From -pi/2 to pi/2
-			return atan(input);
+void Neuron::predictBatch(const Matrix<Half>& featureMatrix, float* output)
+{
+    widenedPredictBatch(featureMatrix, output);
+}
 
-        case ARCTAN01: // From 0 to 1
-			return atan(input) / 3.14159265358979f + 0.5f;
+void Neuron::predictBatch(const Matrix<BFloat16>& featureMatrix, float* output)
+{
+    widenedPredictBatch(featureMatrix, output);
+}
 
-		case SYMMETRICAL_HARD_LIMIT: // -1 to 1
-			if (input > 0) return 1;
-			else if (input == 0) return 0;
-			else return -1;
+/**
+Batch prediction of 16 bit features, widened to float block by block as
+in widenedDeltaLearning
+*/
+template <class T>
+void Neuron::widenedPredictBatch(const Matrix<T>& featureMatrix, float* output)
+{
+    if (!validateBatchFeatureCount(featureMatrix.getFeatureCount()))
+        return;
 
-		case SINUSOID: // -1 to 1
-			return sin(input);
+    int sampleCount = featureMatrix.getSampleCount();
+    int blockSize = wideningBlockSize(featureMatrix.getFeatureCount(), sampleCount);
+    Matrix<float> block;
+    sizeWideningBlock(featureMatrix, blockSize, block);
 
-        case SINUSOID01: // 0 to 1
-			return sin(input) / 2.0f + 0.5f;
+    for (int start = 0; start < sampleCount; start += blockSize)
+    {
+        int count = sampleCount - start < blockSize ? sampleCount - start : blockSize;
+        widenSamples(featureMatrix, start, count, block);
+        predictSamples(block.getArrayRef(), block.getFeatureStride(), block.getSampleStride(), count, output + start);
+    }
+}
 
-		case GAUSSIAN: // 0 to 1
-			return pow(EULER_NUMBER, -input * input);
+/**
+Initialises the weight vector if it has not been set yet and checks that
+it matches the features of the samples to predict
+*/
+bool Neuron::validateBatchFeatureCount(int featureCount)
+{
+    if (!weightMatrixSet)
+        initWeightMatrix(featureCount);
 
-		default:
-			return input; // Assume linear otherwise
+    if (weightMatrix.getSizeX() != featureCount + 1) // +1 because the weight matrix is augmented
+    {
+        std::cout << "Incorrect number of feature dimension entered for batch prediction. Got " << featureCount << ". Expected " << weightMatrix.getSizeX() - 1 << std::endl;
+        return false;
     }
+
+    return true;
 }
 
-float Neuron::derivedActivationFunction(float input)
+/**
+Batch prediction of sampleCount samples, feature k of sample j being
+features[k * featureStride + j * sampleStride] with either stride being 1,
+see predictBatch
+*/
+void Neuron::predictSamples(const float* features, long long featureStride, long long sampleStride, int sampleCount, float* output)
 {
-    switch (activationFunctionEnum)
+    int featureDimension = weightMatrix.getSizeX() - 1;
+    const float* weights = weightMatrix.getArrayRef();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
     {
-		case LINEAR:
-			return 1;
+        if (featureStride == 1)
+        {
+            for (int j = 0; j < sampleCount; j++)
+                output[j] = weights[0] + netInput(weights + 1, features + j * sampleStride, featureDimension);
+            activation.apply(output, sampleCount);
+            return;
+        }
 
-		case HEAVISIDE:
-		    // if (input == 0) return std::numeric_limits<float>::infinity();
-			return 0; // Will not work with back propagation
+        // Blocks of samples small enough for their net inputs to stay in L1 while every feature is added
+        const int blockSize = 1024;
+        for (int start = 0; start < sampleCount; start += blockSize)
+        {
+            int count = sampleCount - start < blockSize ? sampleCount - start : blockSize;
+            float* block = output + start;
 
-		case LOGISTIC:
-			return atan(input) * (1.0f - atan(input)) / 2.0f;
+            for (int j = 0; j < count; j++)
+                block[j] = weights[0]; // Bias, the augmented feature is always 1
 
-        case SOFTMAX:
-            return 0;
+            for (int k = 0; k < featureDimension; k++)
+            {
+                float weight = weights[k + 1];
+                const float* featureRow = features + k * featureStride + start * sampleStride;
+                for (int j = 0; j < count; j++)
+                    block[j] += weight * featureRow[j];
+            }
 
-		case TANH:
-			return 1.0f - pow(activationFunction(input), 2.0f);
+            activation.apply(block, count);
+        }
+    });
+}
 
-		case TANH01:
-			return (1.0f - pow(activationFunction(input), 2.0f)) / 2.0f;
+float Neuron::predict(const SparseMatrix<float>& featureMatrix, int sample)
+{
+    if (!weightMatrixSet)
+        initWeightMatrix(featureMatrix.getFeatureCount());
 
-        case RECTIFIED_LINEAR_UNIT:
-            if (input < 0) return 0;
-            return 1;
+    if (weightMatrix.getSizeX() != featureMatrix.getFeatureCount() + 1) // +1 because the weight matrix is augmented
+    {
+        std::cout << "Incorrect number of feature dimension entered for sparse prediction. Got " << featureMatrix.getFeatureCount() << ". Expected " << weightMatrix.getSizeX() - 1 << std::endl;
+        return -1;
+    }
 
-		case ARCTAN:
-			return 1.0f / (input * input + 1.0f);
+    if (sample < 0 || sample >= featureMatrix.getSampleCount())
+    {
+        std::cout << "Sample " << sample << " is not in the sparse feature matrix of " << featureMatrix.getSampleCount() << " samples" << std::endl;
+        return -1;
+    }
 
-        case ARCTAN01:
-			return 1.0f / (input * input + 1.0f) / 3.14159265358979f; // Unsure here
+    float sum = sparseNetInput(weightMatrix.getArrayRef(), featureMatrix.getSampleIndices(sample), featureMatrix.getSampleValues(sample), featureMatrix.getSampleNonZeroCount(sample));
+    lastNetInput = sum;
+    return activationFunction(sum);
+}
 
-		case SYMMETRICAL_HARD_LIMIT:
-			return 0;
+/**
+Scores every sample of a sparse feature matrix, reading only the weights
+of its non-zero features. output must hold featureMatrix.getSampleCount()
+values.
+*/
+void Neuron::predictBatch(const SparseMatrix<float>& featureMatrix, float* output)
+{
+    if (!validateBatchFeatureCount(featureMatrix.getFeatureCount()))
+        return;
 
-		case SINUSOID:
-			return cos(input);
+    const float* weights = weightMatrix.getArrayRef();
+    for (int j = 0; j < featureMatrix.getSampleCount(); j++)
+        output[j] = sparseNetInput(weights, featureMatrix.getSampleIndices(j), featureMatrix.getSampleValues(j), featureMatrix.getSampleNonZeroCount(j));
+    activationFunction(output, featureMatrix.getSampleCount());
+}
 
-		case SINUSOID01:
-			return cos(input) / 2.0f;
+float Neuron::activationFunction(float input)
+{
+    float output = input;
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        output = activation.apply(input);
+    });
+    return output;
+}
 
-		case GAUSSIAN:
-			return -2 * input * pow(EULER_NUMBER, -input * input);
+/**
+Applies the activation function to every value in place.
+The function is selected once for the whole array rather than once per
+value, which leaves the loops simple enough to be vectorised.
+*/
+void Neuron::activationFunction(float* values, int count)
+{
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        activation.apply(values, count);
+    });
+}
 
-		default:
-			return 1; // Assume linear otherwise
-    }
+float Neuron::derivedActivationFunction(float input)
+{
+    float output = 1;
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        output = activation.derivative(input);
+    });
+    return output;
+}
+
+/**
+Net input of the neuron, the fused dot product of the weight vector and
+the augmented data sample. Both are read straight from their storage
+so no result matrix has to be created.
+Eight independent partial sums let the compiler turn the loop into SIMD
+multiply-adds without reordering any single sum, the result only depends
+on size and not on where the values are stored.
+*/
+float Neuron::netInput(const float* weights, const float* augmentedDataSample, int size)
+{
+    const int lanes = 8;
+    float sums[lanes] = {};
+    int i = 0;
+    for (; i + lanes <= size; i += lanes)
+        for (int l = 0; l < lanes; l++)
+            sums[l] += weights[i + l] * augmentedDataSample[i + l];
+
+    float sum = ((sums[0] + sums[4]) + (sums[1] + sums[5])) + ((sums[2] + sums[6]) + (sums[3] + sums[7]));
+    for (; i < size; i++)
+        sum += weights[i] * augmentedDataSample[i];
+    return sum;
+}
+
+/**
+Net input of the neuron for a sparse sample, given the indices and values
+of its non-zero features: the bias plus the weights of those features
+*/
+float Neuron::sparseNetInput(const float* weights, const int* indices, const float* values, int count)
+{
+    float sum = weights[0]; // The augmented feature is always 1
+    for (int n = 0; n < count; n++)
+        sum += weights[indices[n] + 1] * values[n];
+    return sum;
 }
 
 void Neuron::printWeightMatrix()
@@ -279,6 +1158,107 @@ void Neuron::printWeightMatrix()
     std::cout << std::endl;
 }
 
+/**
+Neuron checkpoint format: this 64 byte header followed by the
+weightSizeX * weightSizeY weights, the checksum covering the weights.
+weightSizeY is always 1, the weights being one augmented weight vector.
+*/
+struct NeuronFileHeader
+{
+    char magic[4]; // "NRNM"
+    uint32_t version;
+    uint32_t activationFunction; // EActivationFunction
+    uint32_t approximateActivation;
+    uint32_t weightSizeX;
+    uint32_t weightSizeY;
+    uint64_t checksum;
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(NeuronFileHeader) == 64, "The neuron file header must stay 64 bytes");
+
+static const char neuronMagic[4] = {'N', 'R', 'N', 'M'};
+static const uint32_t neuronVersion = 1;
+
+bool Neuron::save(const std::string &path)
+{
+    NeuronFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, neuronMagic, sizeof(neuronMagic));
+    header.version = neuronVersion;
+    header.activationFunction = activationFunctionEnum;
+    header.approximateActivation = approximateActivation;
+    header.weightSizeX = weightMatrix.getSizeX();
+    header.weightSizeY = weightMatrix.getSizeY();
+    header.checksum = computeChecksum(weightMatrix.getArrayRef(), weightMatrix.getSize() * sizeof(float));
+
+    // Replaced rather than rewritten in place, the weights may be mapped from path itself
+    try
+    {
+        replaceFile(path, &header, sizeof(header), weightMatrix.getArrayRef(), (size_t) weightMatrix.getSize() * sizeof(float));
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "Neuron save: " << error.what() << "!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+The weights are not copied: the weight matrix points straight into a
+private (copy-on-write) mapping of the file, so loading costs one mmap and
+the checksum pass, and later learning only copies the pages it changes.
+The neuron is left untouched if the file cannot be loaded.
+*/
+bool Neuron::load(const std::string &path)
+{
+    /// 1) Map the file
+    size_t length;
+    std::shared_ptr<void> mapping;
+    try
+    {
+        mapping = mapFile(path, true, length);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "Neuron load: " << error.what() << "!" << std::endl;
+        return false;
+    }
+
+    /// 2) Validate the header and the weights
+    const NeuronFileHeader* header = (const NeuronFileHeader*) mapping.get();
+    if (length < sizeof(NeuronFileHeader) || memcmp(header->magic, neuronMagic, sizeof(neuronMagic)) != 0 || header->version != neuronVersion)
+    {
+        std::cout << "Neuron load: " << path << " is not a neuron checkpoint!" << std::endl;
+        return false;
+    }
+
+    // A neuron holds a single augmented weight vector of at least the bias
+    size_t weightCount = header->weightSizeX;
+    if (header->weightSizeX == 0 || header->weightSizeX > INT_MAX || header->weightSizeY != 1 || weightCount > (length - sizeof(NeuronFileHeader)) / sizeof(float)
+        || header->activationFunction > GAUSSIAN)
+    {
+        std::cout << "Neuron load: The header of " << path << " is corrupt!" << std::endl;
+        return false;
+    }
+
+    float* weights = (float*) ((char*) mapping.get() + sizeof(NeuronFileHeader));
+    if (computeChecksum(weights, weightCount * sizeof(float)) != header->checksum)
+    {
+        std::cout << "Neuron load: The weights in " << path << " do not match their checksum!" << std::endl;
+        return false;
+    }
+
+    /// 3) Adopt the mapped weights
+    activationFunctionEnum = (EActivationFunction) header->activationFunction;
+    approximateActivation = header->approximateActivation != 0;
+    weightMatrix.setStorage(std::shared_ptr<float[]>(mapping, weights), header->weightSizeX, header->weightSizeY);
+    weightMatrixSet = true;
+    return true;
+}
+
 void Neuron::getAugmentedDataSample(Matrix<float>& input, Matrix<float>& output)
 {
     output.setSize(1, input.getSizeX() + 1); // Taken outside the loop to speed things up
@@ -3,7 +3,13 @@
 
 #include "Matrix.h"
 #include "Array.h"
-#include "EActivationFunction.h"
+#include "SparseMatrix.h"
+#include "Activation.h"
+#include "LearningRateSchedule.h"
+
+class SampleReader;
+class NeuronPublisher;
+class ConvergenceMonitor;
 
 class Neuron
 {
@@ -13,23 +19,70 @@ class Neuron
 
         void initWeightMatrix(int featureSize);
         void fillWeightMatrixRandomly(int featureSize, int minValue, int maxValue);
+        void setWeightMatrix(const float* weights, int featureSize); // Copies an augmented weight vector, the bias first
         void deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate);
+        void deltaLearning(Matrix<Half> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate); // 16 bit features, widened to float block by block
+        void deltaLearning(Matrix<BFloat16> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate);
+        void deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, ConvergenceMonitor &monitor); // Stops before epoch epochs once the monitor sees convergence
+        void deltaLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, NeuronPublisher &publisher, int publishInterval); // Publishes the weights every publishInterval samples and at the end
+        void deltaLearning(SparseMatrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate); // Only reads and updates the weights of non-zero features
+        void miniBatchLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int batchSize, int threadCount);
+        void asynchronousLearning(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int threadCount); // Gathers the non-zeros once and learns from them as the sparse overload does
+        void asynchronousLearning(SparseMatrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, int threadCount); // Each update costs O(non-zeros)
+        void streamingLearning(SampleReader &reader, int epoch, float learningRate, int chunkSize); // Delta learning over chunks read ahead in the background
+        void partialFit(const float* features, int featureCount, float target); // One online delta rule update from contiguous features, at the rate of the learning rate schedule
+        void partialFitBatch(const float* features, int featureCount, const float* targets, int sampleCount); // Same for sampleCount samples stored one after another
         void hebbianLearning(Matrix<float> &featureMatrix, int epoch, float learningRate);
+        void hebbianLearning(SparseMatrix<float> &featureMatrix, int epoch, float learningRate);
         float predict(Matrix<float>& dataPoint); // Predicts the classification for the given data point
+        float predict(const MatrixView<const float>& dataPoint); // Same for a data point viewed in place, e.g. a column of a feature matrix
+        float predict(const float* features, int featureCount) const; // Serving path for contiguous features: allocation free, safe to share between threads while no learning runs
+        float predict(const SparseMatrix<float>& featureMatrix, int sample); // Predicts the classification of one sample of a sparse feature matrix
+        void predictBatch(const Matrix<float>& featureMatrix, float* output); // Predicts every sample of the feature matrix, in either layout, into output
+        void predictBatch(const Matrix<Half>& featureMatrix, float* output);
+        void predictBatch(const Matrix<BFloat16>& featureMatrix, float* output);
+        void predictBatch(const SparseMatrix<float>& featureMatrix, float* output);
 
         void printWeightMatrix();
+        bool save(const std::string &path); // Writes a binary checkpoint of the activation function and weights
+        bool load(const std::string &path); // Maps a checkpoint written by save, false if it is missing or corrupt
 
         float activationFunction(float input); // Relays the input to the function specified
+        void activationFunction(float* values, int count); // Applies the function specified to every value in place
         float derivedActivationFunction(float input);
 
         void getAugmentedDataSample(Matrix<float> &input, Matrix<float> &output);
+        static float netInput(const float* weights, const float* augmentedDataSample, int size); // Fused weight-sample dot product
 
         EActivationFunction activationFunctionEnum; // Specifies the learning response function to be used
+        bool approximateActivation; // Use the fast approximations of FastMath.h in the activation function
         Matrix<float> weightMatrix; // Weight matrix of the perceptron
         float lastNetInput; // Weight matrix of the perceptron
+        LearningRateSchedule learningRateSchedule; // Learning rate of partialFit
+        long long updateCount; // Updates made by partialFit, the step of the learning rate schedule
 
 
     private:
+        template <class FeatureMatrix>
+        bool validateLearningData(const char* algorithmName, const FeatureMatrix &featureMatrix, const Array<float> &classificationVector);
+        template <class FeatureMatrix>
+        bool validateFeatureCount(const char* algorithmName, const FeatureMatrix &featureMatrix);
+        template <class T>
+        void widenedDeltaLearning(Matrix<T> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate);
+        template <class T>
+        void widenedPredictBatch(const Matrix<T>& featureMatrix, float* output);
+        bool validateBatchFeatureCount(int featureCount);
+        template <class ActivationPolicy>
+        void partialFitSample(ActivationPolicy activation, const float* features, int featureCount, float target);
+        void predictSamples(const float* features, long long featureStride, long long sampleStride, int sampleCount, float* output);
+        template <class EpochBody>
+        void learnDeltaEpochs(Matrix<float> &featureMatrix, Array<float> &classificationVector, int epoch, float learningRate, EpochBody epochBody);
+        template <class ActivationPolicy>
+        void deltaLearningPass(ActivationPolicy activation, const float* features, long long featureStride, long long sampleStride, const float* targets, int sampleCount, float* augmentedDataSample, float learningRate);
+        template <class ActivationPolicy, class SampleStatistics>
+        void deltaLearningPass(ActivationPolicy activation, const float* features, long long featureStride, long long sampleStride, const float* targets, int sampleCount, float* augmentedDataSample, float learningRate, SampleStatistics &statistics);
+        static float sparseNetInput(const float* weights, const int* indices, const float* values, int count); // Same over the non-zeros of a sample
+
         bool weightMatrixSet;
 };
 
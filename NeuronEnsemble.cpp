@@ -0,0 +1,395 @@
+#include "NeuronEnsemble.h"
+#include "ThreadPool.h"
+#include "Gemm.h"
+#include <stdlib.h>
+#include <iostream>
+
+/**
+Targets of deltaLearning, one row of the target matrix per model
+*/
+struct MatrixTargets
+{
+    const float* targets;
+    int sampleCount;
+
+    float operator()(int model, int sample) const {return targets[(long long) model * sampleCount + sample];}
+};
+
+/**
+Targets of oneVsRestLearning: 1 for the samples of the class of the
+model, 0 for all the others
+*/
+struct OneVsRestTargets
+{
+    const int* classes;
+
+    float operator()(int model, int sample) const {return classes[sample] == model ? 1.0f : 0.0f;}
+};
+
+NeuronEnsemble::NeuronEnsemble(int modelCount)
+{
+    this->modelCount = modelCount < 1 ? 1 : modelCount;
+    weightMatrixSet = false;
+    activationFunctionEnum = HEAVISIDE;
+    approximateActivation = false;
+}
+
+NeuronEnsemble::~NeuronEnsemble()
+{
+
+}
+
+/**
+Draws the weights of the models one after another as
+Neuron::initWeightMatrix does, so an ensemble and K neurons initialised
+in turn from the same seed start from the same weights
+*/
+void NeuronEnsemble::initWeightMatrix(int featureSize)
+{
+    const int minValue = -100;
+    const int range = (100 - minValue) * 1000;
+
+    weightMatrix.setSize(modelCount, featureSize + 1);
+    for (int m = 0; m < modelCount; m++)
+    {
+        float* weights = weightMatrix[m];
+        weights[0] = 1;
+        for (int k = 1; k < featureSize + 1; k++)
+            weights[k] = (float) (rand() % range) / 1000.0f + minValue;
+    }
+    weightMatrixSet = true;
+}
+
+void NeuronEnsemble::setModel(int model, const Neuron &neuron)
+{
+    if (!validateModel(model))
+        return;
+
+    int featureCount = neuron.weightMatrix.getSizeX() - 1;
+    if (featureCount <= 0)
+    {
+        std::cout << "Ensemble: The weights of the neuron have not been set!" << std::endl;
+        return;
+    }
+
+    if (!weightMatrixSet)
+        initWeightMatrix(featureCount);
+
+    if (featureCount != weightMatrix.getSizeY() - 1)
+    {
+        std::cout << "Ensemble: The neuron has " << featureCount << " features, the ensemble " << weightMatrix.getSizeY() - 1 << "!" << std::endl;
+        return;
+    }
+
+    // The neuron weight vector is a single column, stored contiguously
+    const float* neuronWeights = neuron.weightMatrix.getArrayRef();
+    float* weights = weightMatrix[model];
+    for (int k = 0; k < featureCount + 1; k++)
+        weights[k] = neuronWeights[k];
+}
+
+void NeuronEnsemble::getModel(int model, Neuron &neuron) const
+{
+    if (!weightMatrixSet)
+    {
+        std::cout << "Ensemble: The weights of the ensemble have not been set!" << std::endl;
+        return;
+    }
+
+    if (model < 0 || model >= modelCount)
+    {
+        std::cout << "Ensemble: Model " << model << " is not in the ensemble of " << modelCount << " models!" << std::endl;
+        return;
+    }
+
+    neuron.setWeightMatrix(weightMatrix[model], weightMatrix.getSizeY() - 1);
+    neuron.activationFunctionEnum = activationFunctionEnum;
+    neuron.approximateActivation = approximateActivation;
+}
+
+bool NeuronEnsemble::validateModel(int model)
+{
+    if (model < 0 || model >= modelCount)
+    {
+        std::cout << "Ensemble: Model " << model << " is not in the ensemble of " << modelCount << " models!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+Checks that the features of the feature matrix, in either layout, match
+the weight vectors, initialising them if they have not been set yet
+*/
+bool NeuronEnsemble::validateFeatureCount(const char* algorithmName, const Matrix<float> &featureMatrix)
+{
+    if (!weightMatrixSet)
+        initWeightMatrix(featureMatrix.getFeatureCount());
+
+    if (featureMatrix.getFeatureCount() != weightMatrix.getSizeY() - 1)
+    {
+        std::cout << algorithmName << ": The feature dimensionality size in the feature matrix must equal to the weight matrix size!" << std::endl;
+        return false;
+    }
+
+    if (featureMatrix.getFeatureCount() <= 0)
+    {
+        std::cout << algorithmName << ": The feature dimension must be larger than 0 for learning to occur!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+Delta learning of every model against its own row of targets,
+targetMatrix[model][sample]
+*/
+void NeuronEnsemble::deltaLearning(Matrix<float> &featureMatrix, Matrix<float> &targetMatrix, int epoch, float learningRate, int threadCount)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateFeatureCount("Ensemble delta learning", featureMatrix))
+        return;
+
+    if (targetMatrix.getSizeX() != modelCount || targetMatrix.getSizeY() != featureMatrix.getSampleCount())
+    {
+        std::cout << "Ensemble delta learning: The target matrix must hold one target per model and sample!" << std::endl;
+        return;
+    }
+
+    /// Proceed with the delta learning algorithm
+    MatrixTargets targets = {targetMatrix.getArrayRef(), featureMatrix.getSampleCount()};
+    learnModels(featureMatrix, targets, epoch, learningRate, threadCount);
+}
+
+/**
+One-vs-rest delta learning, classVector holding the class of every sample
+from 0 to getModelCount() - 1. Model c learns the target 1 for the
+samples of class c and 0 for the others, so the activation function
+should range from 0 to 1 (e.g. TANH01 or LOGISTIC).
+*/
+void NeuronEnsemble::oneVsRestLearning(Matrix<float> &featureMatrix, Array<int> &classVector, int epoch, float learningRate, int threadCount)
+{
+    /// 1) Check for any missed/erroneous parameters
+    if (!validateFeatureCount("One-vs-rest learning", featureMatrix))
+        return;
+
+    if (featureMatrix.getSampleCount() != classVector.size())
+    {
+        std::cout << "One-vs-rest learning: The number of samples in the feature matrix must equal to the class vector size!" << std::endl;
+        return;
+    }
+
+    for (int j = 0; j < classVector.size(); j++)
+        if (classVector[j] < 0 || classVector[j] >= modelCount)
+        {
+            std::cout << "One-vs-rest learning: Sample " << j << " is of class " << classVector[j] << ", the ensemble has " << modelCount << " models!" << std::endl;
+            return;
+        }
+
+    /// Proceed with the delta learning algorithm
+    OneVsRestTargets targets = {classVector.getArray()};
+    learnModels(featureMatrix, targets, epoch, learningRate, threadCount);
+}
+
+/**
+Delta learning of all the models in one stream over the samples.
+Every thread owns a contiguous range of models and runs all the epochs
+over all the samples for them, without any barrier since the models do
+not share anything. Per sample, a feature-major sample is gathered once
+per thread, then the responses of the models of the range (a matrix-vector
+product) and their updates (w = w + n(t - y)x) are computed row by row,
+each weight row being updated right after its dot product while it is
+still in cache. Every model does the arithmetic of
+Neuron::deltaLearningPass in the same order, so the result does not depend
+on the thread count and matches training the models one by one.
+*/
+template <class TargetPolicy>
+void NeuronEnsemble::learnModels(Matrix<float> &featureMatrix, TargetPolicy target, int epoch, float learningRate, int threadCount)
+{
+    int featureDimension = featureMatrix.getFeatureCount();
+    int sampleCount = featureMatrix.getSampleCount();
+    long long featureStride = featureMatrix.getFeatureStride();
+    long long sampleStride = featureMatrix.getSampleStride();
+    int weightSize = featureDimension + 1;
+    if (threadCount > modelCount)
+        threadCount = modelCount;
+    ThreadPool threadPool(threadCount);
+    threadCount = threadPool.getThreadCount();
+
+    // One augmented sample buffer per thread, padded to whole cache lines against false sharing
+    int bufferStride = (weightSize + 15) / 16 * 16;
+    Matrix<float> augmentedDataSamples(threadCount, bufferStride);
+    for (int t = 0; t < threadCount; t++)
+        augmentedDataSamples[t][0] = 1; // This value is always 1
+
+    float* weights = weightMatrix.getArrayRef();
+    const float* features = featureMatrix.getArrayRef();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        auto learnModelRange = [&](int thread)
+        {
+            int modelStart = (int) ((long long) modelCount * thread / threadCount);
+            int modelEnd = (int) ((long long) modelCount * (thread + 1) / threadCount);
+            float* augmentedDataSample = augmentedDataSamples[thread];
+
+            // Loop the delta learning rule epoch times
+            for (int i = 0; i < epoch; i++)
+            {
+                for (int j = 0; j < sampleCount; j++)
+                {
+                    const float* sample = features + j * sampleStride;
+                    if (featureStride != 1)
+                    {
+                        // Set the data for the augmented sample matrix (vector)
+                        for (int k = 0; k < featureDimension; k++)
+                            augmentedDataSample[k + 1] = sample[k * featureStride];
+                        sample = augmentedDataSample + 1;
+                    }
+
+                    for (int m = modelStart; m < modelEnd; m++)
+                    {
+                        float* modelWeights = weights + (long long) m * weightSize;
+
+                        // Calculate the model response, the augmented feature is always 1
+                        float response = activation.apply(modelWeights[0] + Neuron::netInput(modelWeights + 1, sample, featureDimension));
+
+                        // Update the weight with Delta update rule: w = w + n(t - y)x
+                        float factor = learningRate * (target(m, j) - response); // n(t - y)
+                        modelWeights[0] = modelWeights[0] + factor;
+                        float* featureWeights = modelWeights + 1;
+                        for (int k = 0; k < featureDimension; k++)
+                            featureWeights[k] = featureWeights[k] + factor * sample[k];
+                    }
+                }
+            }
+        };
+        threadPool.run(learnModelRange);
+    });
+}
+
+/**
+Net inputs of every model for samples start to start + count - 1, model m
+and sample start + j going to output[m * outputStride + j].
+The product of the weight matrix and the block of samples runs through
+gemm, the feature matrix being read in place in either layout.
+*/
+void NeuronEnsemble::netInputs(const Matrix<float> &featureMatrix, int start, int count, float* output, int outputStride)
+{
+    int featureDimension = featureMatrix.getFeatureCount();
+    int weightSize = featureDimension + 1;
+    const float* weights = weightMatrix.getArrayRef();
+
+    // In gemm terms output is count x modelCount and the feature weights are featureDimension x modelCount
+    if (featureMatrix.getLayout() == SAMPLE_MAJOR)
+        gemm(true, false, count, modelCount, featureDimension, featureMatrix[start], featureDimension, weights + 1, weightSize, output, outputStride);
+    else
+        gemm(false, false, count, modelCount, featureDimension, featureMatrix.getArrayRef() + start, featureMatrix.getSampleCount(), weights + 1, weightSize, output, outputStride);
+
+    // Add the biases, the augmented feature is always 1
+    for (int m = 0; m < modelCount; m++)
+    {
+        float bias = weights[(long long) m * weightSize];
+        float* modelOutput = output + (long long) m * outputStride;
+        for (int j = 0; j < count; j++)
+            modelOutput[j] += bias;
+    }
+}
+
+/**
+output is resized to getModelCount() x the number of samples
+*/
+void NeuronEnsemble::predictBatch(const Matrix<float> &featureMatrix, Matrix<float> &output)
+{
+    if (!validateFeatureCount("Ensemble prediction", featureMatrix))
+        return;
+
+    int sampleCount = featureMatrix.getSampleCount();
+    output.setSize(modelCount, sampleCount);
+    if (sampleCount == 0)
+        return;
+    netInputs(featureMatrix, 0, sampleCount, output.getArrayRef(), sampleCount);
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        for (int m = 0; m < modelCount; m++)
+            activation.apply(output[m], sampleCount);
+    });
+}
+
+/**
+The class is the model with the largest net input, the first one on a
+tie. Net inputs rather than responses are compared since saturated or
+thresholded responses (e.g. HEAVISIDE) tie far more often, for the
+increasing activation functions the order is the same.
+*/
+int NeuronEnsemble::predictClass(const MatrixView<const float> &dataPoint)
+{
+    if (!weightMatrixSet)
+        initWeightMatrix(dataPoint.getSizeX());
+
+    if (weightMatrix.getSizeY() != dataPoint.getSizeX() + 1) // +1 because the weight matrix is augmented
+    {
+        std::cout << "Incorrect number of feature dimension entered for data point. Got " << dataPoint.getSizeX() << ". Expected " << weightMatrix.getSizeY() - 1 << std::endl;
+        return -1;
+    }
+
+    int bestModel = 0;
+    float bestNetInput = 0;
+    for (int m = 0; m < modelCount; m++)
+    {
+        const float* weights = weightMatrix[m];
+        float sum = weights[0];
+        for (int k = 0; k < dataPoint.getSizeX(); k++)
+            sum += weights[k + 1] * dataPoint[k][0];
+
+        if (m == 0 || sum > bestNetInput)
+        {
+            bestModel = m;
+            bestNetInput = sum;
+        }
+    }
+    return bestModel;
+}
+
+/**
+Classifies every sample of the feature matrix, see predictClass.
+The net inputs are computed a block of samples at a time and the best
+model is tracked model by model, a contiguous sweep over each row of the
+block. classes must hold featureMatrix.getSampleCount() values.
+*/
+void NeuronEnsemble::predictClasses(const Matrix<float> &featureMatrix, int* classes)
+{
+    if (!validateFeatureCount("Ensemble classification", featureMatrix))
+        return;
+
+    const int blockSize = 1024;
+    if (scoreBlock.getSizeX() != modelCount || scoreBlock.getSizeY() != blockSize)
+        scoreBlock.setSize(modelCount, blockSize);
+
+    int sampleCount = featureMatrix.getSampleCount();
+    for (int start = 0; start < sampleCount; start += blockSize)
+    {
+        int count = sampleCount - start < blockSize ? sampleCount - start : blockSize;
+        netInputs(featureMatrix, start, count, scoreBlock.getArrayRef(), blockSize);
+
+        // The first row keeps the best net input of every sample
+        float* bestNetInputs = scoreBlock[0];
+        int* blockClasses = classes + start;
+        for (int j = 0; j < count; j++)
+            blockClasses[j] = 0;
+
+        for (int m = 1; m < modelCount; m++)
+        {
+            const float* modelNetInputs = scoreBlock[m];
+            for (int j = 0; j < count; j++)
+                if (modelNetInputs[j] > bestNetInputs[j])
+                {
+                    bestNetInputs[j] = modelNetInputs[j];
+                    blockClasses[j] = m;
+                }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef NEURONENSEMBLE_H
+#define NEURONENSEMBLE_H
+
+#include "Neuron.h"
+
+/**
+    K independent perceptrons trained together over the same feature
+    matrix, e.g. one per class (one-vs-rest) or one per tenant.
+    The K augmented weight vectors are the rows of one weight matrix,
+    weightMatrix[model][k] with the bias at k = 0. A learning pass streams
+    every sample once for all the models instead of once per model, the
+    models being split into contiguous ranges, one per thread. Each model
+    learns exactly as Neuron::deltaLearning would on its own.
+*/
+class NeuronEnsemble
+{
+    public:
+        NeuronEnsemble(int modelCount);
+        ~NeuronEnsemble();
+
+        void initWeightMatrix(int featureSize); // Initialises every model like Neuron::initWeightMatrix
+        void setModel(int model, const Neuron &neuron); // Takes over the weights of the neuron
+        void getModel(int model, Neuron &neuron) const; // Copies the weights and activation function of a model into the neuron
+
+        int getModelCount() const {return modelCount;}
+        int getFeatureCount() const {return weightMatrixSet ? weightMatrix.getSizeY() - 1 : 0;}
+
+        void deltaLearning(Matrix<float> &featureMatrix, Matrix<float> &targetMatrix, int epoch, float learningRate, int threadCount); // targetMatrix[model][sample]
+        void oneVsRestLearning(Matrix<float> &featureMatrix, Array<int> &classVector, int epoch, float learningRate, int threadCount); // Model c learns class c against all the others
+        void predictBatch(const Matrix<float> &featureMatrix, Matrix<float> &output); // Responses of every model to every sample, output[model][sample]
+        int predictClass(const MatrixView<const float> &dataPoint); // Model with the largest net input, -1 on error
+        void predictClasses(const Matrix<float> &featureMatrix, int* classes); // Same for every sample of the feature matrix
+
+        EActivationFunction activationFunctionEnum; // Shared by all the models
+        bool approximateActivation;
+        Matrix<float> weightMatrix; // One augmented weight vector per model
+
+    private:
+        bool validateFeatureCount(const char* algorithmName, const Matrix<float> &featureMatrix);
+        bool validateModel(int model);
+        template <class TargetPolicy>
+        void learnModels(Matrix<float> &featureMatrix, TargetPolicy target, int epoch, float learningRate, int threadCount);
+        void netInputs(const Matrix<float> &featureMatrix, int start, int count, float* output, int outputStride);
+
+        int modelCount;
+        bool weightMatrixSet;
+        Matrix<float> scoreBlock; // Buffer of predictClasses
+};
+
+#endif // NEURONENSEMBLE_H
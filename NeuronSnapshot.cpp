@@ -0,0 +1,188 @@
+#include "NeuronSnapshot.h"
+#include <iostream>
+
+float NeuronSnapshot::predict(const float* features, int featureCount) const
+{
+    if (featureCount != getFeatureCount())
+    {
+        std::cout << "Incorrect number of feature dimension entered for data point. Got " << featureCount << ". Expected " << getFeatureCount() << std::endl;
+        return -1;
+    }
+
+    const float* weightVector = weights.getArray();
+    float sum = weightVector[0] + Neuron::netInput(weightVector + 1, features, featureCount); // The augmented feature is always 1
+    float output = sum;
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        output = activation.apply(sum);
+    });
+    return output;
+}
+
+NeuronPublisher::NeuronPublisher(int maxReaders)
+{
+    this->maxReaders = maxReaders < 1 ? 1 : maxReaders;
+    slots.reset(new ReaderSlot[this->maxReaders]);
+    for (int i = 0; i < this->maxReaders; i++)
+    {
+        slots[i].epoch.store(idleEpoch, std::memory_order_relaxed);
+        slots[i].inUse.store(false, std::memory_order_relaxed);
+    }
+    current.store(nullptr, std::memory_order_relaxed);
+    globalEpoch.store(0, std::memory_order_relaxed);
+    version.store(0, std::memory_order_relaxed);
+}
+
+NeuronPublisher::~NeuronPublisher()
+{
+    delete current.load(std::memory_order_acquire);
+    for (RetiredSnapshot &retiredSnapshot : retired)
+        delete retiredSnapshot.snapshot;
+    for (NeuronSnapshot* snapshot : spare)
+        delete snapshot;
+}
+
+/**
+The weights are copied into a reclaimed snapshot when there is one, the
+new snapshot is swapped in and the old one retired in the current epoch,
+which then advances
+*/
+void NeuronPublisher::publish(const Neuron &neuron)
+{
+    if (neuron.weightMatrix.getSizeX() < 2)
+    {
+        std::cout << "Neuron publish: The weights of the neuron have not been set!" << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(publishMutex);
+
+    /// 1) Copy the weights into a snapshot no reader can see yet
+    NeuronSnapshot* snapshot;
+    if (spare.empty())
+        snapshot = new NeuronSnapshot();
+    else
+    {
+        snapshot = spare.back();
+        spare.pop_back();
+    }
+
+    int weightSize = neuron.weightMatrix.getSizeX();
+    if (snapshot->weights.size() != weightSize)
+        snapshot->weights.setSize(weightSize);
+    const float* neuronWeights = neuron.weightMatrix.getArrayRef(); // A single column, stored contiguously
+    float* weights = snapshot->weights.getArray();
+    for (int k = 0; k < weightSize; k++)
+        weights[k] = neuronWeights[k];
+    snapshot->activationFunctionEnum = neuron.activationFunctionEnum;
+    snapshot->approximateActivation = neuron.approximateActivation;
+    snapshot->version = version.load(std::memory_order_relaxed) + 1;
+
+    /// 2) Swap it in, the release orders the copy before it
+    NeuronSnapshot* replaced = current.exchange(snapshot, std::memory_order_acq_rel);
+    version.store(snapshot->version, std::memory_order_release);
+
+    /// 3) Retire the replaced snapshot and free what no reader can still hold
+    if (replaced)
+        retired.push_back({replaced, globalEpoch.load(std::memory_order_relaxed)});
+    globalEpoch.fetch_add(1, std::memory_order_acq_rel);
+    reclaim();
+}
+
+/**
+A reader pinned in epoch e may hold any snapshot retired in epoch e or
+later, so the snapshots retired before the oldest pinned epoch are free.
+The fence pairs with the one in NeuronReader::pin: either this scan sees
+the epoch the reader announced, or the reader sees the new snapshot.
+*/
+void NeuronPublisher::reclaim()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    long long oldestEpoch = idleEpoch;
+    for (int i = 0; i < maxReaders; i++)
+    {
+        long long epoch = slots[i].epoch.load(std::memory_order_acquire);
+        if (epoch < oldestEpoch)
+            oldestEpoch = epoch;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++)
+    {
+        if (retired[i].epoch < oldestEpoch)
+            spare.push_back(retired[i].snapshot);
+        else
+            retired[kept++] = retired[i];
+    }
+    retired.resize(kept);
+}
+
+int NeuronPublisher::getRetiredCount()
+{
+    std::lock_guard<std::mutex> lock(publishMutex);
+    return (int) retired.size();
+}
+
+int NeuronPublisher::acquireSlot()
+{
+    for (int i = 0; i < maxReaders; i++)
+    {
+        bool expected = false;
+        if (!slots[i].inUse.load(std::memory_order_relaxed) && slots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return i;
+    }
+
+    std::cout << "Neuron reader: All " << maxReaders << " reader slots of the publisher are taken!" << std::endl;
+    return -1;
+}
+
+void NeuronPublisher::releaseSlot(int slot)
+{
+    slots[slot].epoch.store(idleEpoch, std::memory_order_release);
+    slots[slot].inUse.store(false, std::memory_order_release);
+}
+
+NeuronReader::NeuronReader(NeuronPublisher &publisher) : publisher(publisher)
+{
+    slot = publisher.acquireSlot();
+}
+
+NeuronReader::~NeuronReader()
+{
+    if (slot >= 0)
+        publisher.releaseSlot(slot);
+}
+
+/**
+Announces the current epoch before loading the snapshot, see
+NeuronPublisher::reclaim. Lock free: a store, a fence and two loads.
+*/
+const NeuronSnapshot* NeuronReader::pin()
+{
+    if (slot < 0)
+        return nullptr;
+
+    std::atomic<long long> &epoch = publisher.slots[slot].epoch;
+    epoch.store(publisher.globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return publisher.current.load(std::memory_order_acquire);
+}
+
+/**
+The release orders every read of the snapshot before a publisher can see
+the reader as idle and reuse it
+*/
+void NeuronReader::unpin()
+{
+    if (slot >= 0)
+        publisher.slots[slot].epoch.store(NeuronPublisher::idleEpoch, std::memory_order_release);
+}
+
+float NeuronReader::predict(const float* features, int featureCount)
+{
+    const NeuronSnapshot* snapshot = pin();
+    float output = snapshot ? snapshot->predict(features, featureCount) : -1;
+    unpin();
+    return output;
+}
@@ -0,0 +1,110 @@
+#ifndef NEURONSNAPSHOT_H
+#define NEURONSNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Neuron.h"
+
+/**
+    Immutable copy of the weights and activation function of a Neuron, as
+    published by NeuronPublisher. Readers only ever see it as const.
+*/
+struct NeuronSnapshot
+{
+    long long version; // 1 for the first publish, then increasing
+    EActivationFunction activationFunctionEnum;
+    bool approximateActivation;
+    Array<float> weights; // Augmented weight vector, the bias first
+
+    int getFeatureCount() const {return weights.size() - 1;}
+    float predict(const float* features, int featureCount) const; // Same as Neuron::predict on contiguous features
+};
+
+/**
+    Read-copy-update publication of the weights of a neuron that keeps
+    learning while it is served.
+    The trainer copies its weights into a new snapshot with publish and
+    swaps it in atomically. Readers pin the current snapshot through a
+    NeuronReader without taking any lock: pinning is an announcement of the
+    epoch the reader started in and one atomic load. A replaced snapshot is
+    retired with the epoch it was replaced in and reclaimed once no reader
+    is pinned in that epoch or an earlier one (epoch based reclamation),
+    after which publish reuses its storage, so publishing does not
+    allocate in the steady state.
+    Publishing is serialised by a mutex, only the trainers take it.
+*/
+class NeuronPublisher
+{
+    public:
+        NeuronPublisher(int maxReaders = 64);
+        ~NeuronPublisher(); // No reader may be left
+
+        void publish(const Neuron &neuron); // Makes a copy of the current weights of the neuron the current snapshot
+        long long getVersion() const {return version.load(std::memory_order_acquire);} // Version of the latest publish, 0 before the first
+        int getRetiredCount(); // Replaced snapshots still waiting for their readers
+
+    private:
+        friend class NeuronReader;
+
+        /**
+        Epoch a reader is pinned in, idleEpoch when it is not pinned.
+        One cache line each so readers do not slow each other down.
+        */
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<long long> epoch;
+            std::atomic<bool> inUse;
+        };
+
+        struct RetiredSnapshot
+        {
+            NeuronSnapshot* snapshot;
+            long long epoch;
+        };
+
+        static const long long idleEpoch = 0x7fffffffffffffffLL;
+
+        int acquireSlot();
+        void releaseSlot(int slot);
+        void reclaim();
+
+        int maxReaders;
+        std::unique_ptr<ReaderSlot[]> slots;
+        std::atomic<NeuronSnapshot*> current;
+        std::atomic<long long> globalEpoch;
+        std::atomic<long long> version;
+
+        std::mutex publishMutex;
+        std::vector<RetiredSnapshot> retired;
+        std::vector<NeuronSnapshot*> spare; // Reclaimed snapshots, reused by publish
+};
+
+/**
+    Reading side of a NeuronPublisher, one per reading thread.
+    pin returns the current snapshot, which stays valid and unchanged until
+    unpin, the next pin or the destruction of the reader. It returns
+    nullptr before the first publish or if the publisher has no free
+    reader slot.
+*/
+class NeuronReader
+{
+    public:
+        NeuronReader(NeuronPublisher &publisher);
+        ~NeuronReader();
+
+        const NeuronSnapshot* pin();
+        void unpin();
+        float predict(const float* features, int featureCount); // Pins, predicts with the current snapshot and unpins, -1 if there is none
+
+    private:
+        NeuronReader(const NeuronReader &) = delete;
+        NeuronReader &operator=(const NeuronReader &) = delete;
+
+        NeuronPublisher &publisher;
+        int slot;
+};
+
+#endif // NEURONSNAPSHOT_H
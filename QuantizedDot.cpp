@@ -0,0 +1,118 @@
+#include "QuantizedDot.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANTIZED_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+struct QuantizedDotKernel
+{
+    const char* name;
+    int32_t (*dot)(const int8_t* a, const int8_t* b, int size);
+};
+
+static int32_t dotPortable(const int8_t* a, const int8_t* b, int size)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < size; i++)
+        sum += (int32_t) a[i] * b[i];
+    return sum;
+}
+
+#ifdef QUANTIZED_X86_KERNELS
+
+__attribute__((target("avx2")))
+static int32_t horizontalSum(__m256i sum)
+{
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+
+/// AVX2, 32 pairs per step: maddubs into 16 bit pair sums, madd by 1 into 32 bit sums
+__attribute__((target("avx2")))
+static int32_t dotAvx2(const int8_t* a, const int8_t* b, int size)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i pairs = _mm256_maddubs_epi16(_mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+    }
+
+    int32_t total = horizontalSum(sum);
+    for (; i < size; i++)
+        total += (int32_t) a[i] * b[i];
+    return total;
+}
+
+/// AVX-512 VNNI on 256 bit vectors, vpdpbusd sums four products straight into 32 bit lanes
+__attribute__((target("avx2,avx512vnni,avx512vl")))
+static int32_t dotVnni(const int8_t* a, const int8_t* b, int size)
+{
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        __m256i va0 = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i vb0 = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i va1 = _mm256_loadu_si256((const __m256i*) (a + i + 32));
+        __m256i vb1 = _mm256_loadu_si256((const __m256i*) (b + i + 32));
+        sum0 = _mm256_dpbusd_epi32(sum0, _mm256_abs_epi8(va0), _mm256_sign_epi8(vb0, va0));
+        sum1 = _mm256_dpbusd_epi32(sum1, _mm256_abs_epi8(va1), _mm256_sign_epi8(vb1, va1));
+    }
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+        sum0 = _mm256_dpbusd_epi32(sum0, _mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+    }
+
+    int32_t total = horizontalSum(_mm256_add_epi32(sum0, sum1));
+    for (; i < size; i++)
+        total += (int32_t) a[i] * b[i];
+    return total;
+}
+
+#endif // QUANTIZED_X86_KERNELS
+
+static QuantizedDotKernel selectKernel()
+{
+#ifdef QUANTIZED_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx2"))
+        return {"avx512vnni", dotVnni};
+    if (__builtin_cpu_supports("avx2"))
+        return {"avx2", dotAvx2};
+#endif
+    return {"portable", dotPortable};
+}
+
+static const QuantizedDotKernel& kernel()
+{
+    static const QuantizedDotKernel kernel = selectKernel();
+    return kernel;
+}
+
+int32_t quantizedDot(const int8_t* a, const int8_t* b, int size)
+{
+    return kernel().dot(a, b, size);
+}
+
+void quantizedDotBatch(const int8_t* weights, const int8_t* samples, long long sampleStride, int size, int sampleCount, int32_t* output)
+{
+    int32_t (*dot)(const int8_t*, const int8_t*, int) = kernel().dot;
+    for (int j = 0; j < sampleCount; j++)
+        output[j] = dot(weights, samples + j * sampleStride, size);
+}
+
+const char* getQuantizedDotKernelName()
+{
+    return kernel().name;
+}
@@ -0,0 +1,28 @@
+#ifndef QUANTIZEDDOT_H_INCLUDED
+#define QUANTIZEDDOT_H_INCLUDED
+
+#include <stdint.h>
+
+/**
+    int8 x int8 -> int32 dot product kernels behind QuantizedNeuron.
+
+    Both operands must lie within [-127, 127], which the quantization
+    guarantees: the SIMD kernels multiply |a| by b with the sign of a
+    (maddubs and VNNI take one unsigned operand), and a pair of such
+    products then still fits the 16 bit lanes of maddubs. The int32 sum
+    cannot overflow below about 130000 elements.
+
+    The kernel (AVX-512 VNNI, AVX2 or portable) is chosen once at runtime
+    from what the CPU supports.
+*/
+int32_t quantizedDot(const int8_t* a, const int8_t* b, int size);
+
+/**
+    output[j] = quantizedDot(weights, samples + j * sampleStride, size)
+    for sampleCount samples stored one after another
+*/
+void quantizedDotBatch(const int8_t* weights, const int8_t* samples, long long sampleStride, int size, int sampleCount, int32_t* output);
+
+const char* getQuantizedDotKernelName(); // Name of the kernel chosen for this CPU
+
+#endif // QUANTIZEDDOT_H_INCLUDED
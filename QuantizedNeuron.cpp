@@ -0,0 +1,191 @@
+#include "QuantizedNeuron.h"
+#include "QuantizedDot.h"
+#include <math.h>
+#include <iostream>
+
+/**
+Scale mapping the largest magnitude of the values to 127, so that -128
+is never used (see QuantizedDot.h)
+*/
+static float quantizationScale(float maxMagnitude)
+{
+    return maxMagnitude > 0 ? maxMagnitude / 127.0f : 1.0f;
+}
+
+static int8_t quantizeValue(float value, float inverseScale)
+{
+    long rounded = lrintf(value * inverseScale);
+    if (rounded > 127)
+        rounded = 127;
+    if (rounded < -127)
+        rounded = -127;
+    return (int8_t) rounded;
+}
+
+QuantizedFeatureMatrix::QuantizedFeatureMatrix()
+{
+    featureCount = 0;
+    sampleCount = 0;
+    scale = 1;
+}
+
+QuantizedFeatureMatrix::QuantizedFeatureMatrix(const Matrix<float> &featureMatrix) : QuantizedFeatureMatrix()
+{
+    quantize(featureMatrix);
+}
+
+QuantizedFeatureMatrix::~QuantizedFeatureMatrix()
+{
+
+}
+
+void QuantizedFeatureMatrix::quantize(const Matrix<float> &featureMatrix)
+{
+    featureCount = featureMatrix.getFeatureCount();
+    sampleCount = featureMatrix.getSampleCount();
+    const float* features = featureMatrix.getArrayRef();
+    long long featureStride = featureMatrix.getFeatureStride();
+    long long sampleStride = featureMatrix.getSampleStride();
+
+    /// 1) One scale for the whole matrix
+    float maxMagnitude = 0;
+    for (long long i = 0; i < (long long) featureCount * sampleCount; i++)
+        maxMagnitude = fmaxf(maxMagnitude, fabsf(features[i]));
+    scale = quantizationScale(maxMagnitude);
+    float inverseScale = 1.0f / scale;
+
+    /// 2) Samples stored one after another
+    values.setSize(featureCount * sampleCount);
+    int8_t* quantized = values.getArray();
+    for (int j = 0; j < sampleCount; j++)
+    {
+        const float* sample = features + j * sampleStride;
+        int8_t* quantizedSample = quantized + (long long) j * featureCount;
+        for (int k = 0; k < featureCount; k++)
+            quantizedSample[k] = quantizeValue(sample[k * featureStride], inverseScale);
+    }
+}
+
+QuantizedNeuron::QuantizedNeuron()
+{
+    featureCount = 0;
+    weightScale = 1;
+    bias = 0;
+    activationFunctionEnum = HEAVISIDE;
+    approximateActivation = false;
+}
+
+QuantizedNeuron::QuantizedNeuron(const Neuron &neuron) : QuantizedNeuron()
+{
+    quantize(neuron);
+}
+
+QuantizedNeuron::~QuantizedNeuron()
+{
+
+}
+
+void QuantizedNeuron::quantize(const Neuron &neuron)
+{
+    if (neuron.weightMatrix.getSizeX() < 2)
+    {
+        std::cout << "Quantization: The neuron has no weights to quantize, it must learn or load a checkpoint first!" << std::endl;
+        return;
+    }
+
+    activationFunctionEnum = neuron.activationFunctionEnum;
+    approximateActivation = neuron.approximateActivation;
+    featureCount = neuron.weightMatrix.getSizeX() - 1;
+    const float* neuronWeights = neuron.weightMatrix.getArrayRef();
+    bias = neuronWeights[0];
+
+    float maxMagnitude = 0;
+    for (int k = 0; k < featureCount; k++)
+        maxMagnitude = fmaxf(maxMagnitude, fabsf(neuronWeights[k + 1]));
+    weightScale = quantizationScale(maxMagnitude);
+    float inverseScale = 1.0f / weightScale;
+
+    weights.setSize(featureCount);
+    for (int k = 0; k < featureCount; k++)
+        weights[k] = quantizeValue(neuronWeights[k + 1], inverseScale);
+}
+
+bool QuantizedNeuron::validateFeatureCount(int dataFeatureCount)
+{
+    if (featureCount == 0)
+    {
+        std::cout << "Quantized prediction: The neuron has not been quantized!" << std::endl;
+        return false;
+    }
+
+    if (dataFeatureCount != featureCount)
+    {
+        std::cout << "Incorrect number of feature dimension entered for quantized prediction. Got " << dataFeatureCount << ". Expected " << featureCount << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+float QuantizedNeuron::predict(const MatrixView<const float>& dataPoint)
+{
+    if (!validateFeatureCount(dataPoint.getSizeX()))
+        return -1;
+
+    float maxMagnitude = 0;
+    for (int k = 0; k < featureCount; k++)
+        maxMagnitude = fmaxf(maxMagnitude, fabsf(dataPoint[k][0]));
+    float featureScale = quantizationScale(maxMagnitude);
+    float inverseScale = 1.0f / featureScale;
+
+    if (quantizedDataPoint.size() != featureCount)
+        quantizedDataPoint.setSize(featureCount);
+    for (int k = 0; k < featureCount; k++)
+        quantizedDataPoint[k] = quantizeValue(dataPoint[k][0], inverseScale);
+
+    float netInput = bias + weightScale * featureScale * quantizedDot(weights.getArray(), quantizedDataPoint.getArray(), featureCount);
+    float output = netInput;
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        output = activation.apply(netInput);
+    });
+    return output;
+}
+
+/**
+The integer dot products of a block of samples are scaled back to net
+inputs and passed through the activation function together.
+output must hold featureMatrix.getSampleCount() values.
+*/
+void QuantizedNeuron::predictBatch(const QuantizedFeatureMatrix &featureMatrix, float* output)
+{
+    if (!validateFeatureCount(featureMatrix.getFeatureCount()))
+        return;
+
+    int sampleCount = featureMatrix.getSampleCount();
+    float scale = weightScale * featureMatrix.getScale();
+
+    dispatchActivation(activationFunctionEnum, approximateActivation, [&](auto activation)
+    {
+        const int blockSize = 1024;
+        int32_t dots[blockSize];
+        for (int start = 0; start < sampleCount; start += blockSize)
+        {
+            int count = sampleCount - start < blockSize ? sampleCount - start : blockSize;
+            float* block = output + start;
+            quantizedDotBatch(weights.getArray(), featureMatrix.getSample(start), featureCount, featureCount, count, dots);
+            for (int j = 0; j < count; j++)
+                block[j] = bias + scale * dots[j];
+            activation.apply(block, count);
+        }
+    });
+}
+
+void QuantizedNeuron::predictBatch(const Matrix<float> &featureMatrix, float* output)
+{
+    if (!validateFeatureCount(featureMatrix.getFeatureCount()))
+        return;
+
+    quantizedFeatures.quantize(featureMatrix);
+    predictBatch(quantizedFeatures, output);
+}
@@ -0,0 +1,75 @@
+#ifndef QUANTIZEDNEURON_H
+#define QUANTIZEDNEURON_H
+
+#include <stdint.h>
+
+#include "Neuron.h"
+
+/**
+    int8 copy of a data set for QuantizedNeuron. Every sample is stored
+    contiguously (sample-major) as round(x / scale), one scale for the
+    whole matrix (per-tensor) chosen so that its largest magnitude maps to
+    127. It takes a quarter of the memory of the float features.
+*/
+class QuantizedFeatureMatrix
+{
+    public:
+        QuantizedFeatureMatrix();
+        explicit QuantizedFeatureMatrix(const Matrix<float> &featureMatrix);
+        ~QuantizedFeatureMatrix();
+
+        void quantize(const Matrix<float> &featureMatrix); // Either layout, storage is reused when large enough
+
+        int getFeatureCount() const {return featureCount;}
+        int getSampleCount() const {return sampleCount;}
+        float getScale() const {return scale;}
+        const int8_t* getSample(int sample) const {return values.getArray() + (long long) sample * featureCount;}
+
+    private:
+        int featureCount, sampleCount;
+        float scale;
+        Array<int8_t> values;
+};
+
+/**
+    Frozen, int8 quantized copy of a trained Neuron for serving.
+    The feature weights are quantized with one scale for the whole vector
+    (per-tensor), the bias stays a float. A net input is then
+    bias + weightScale * featureScale * (int8 weights . int8 features),
+    the dot product running in the int32 kernels of QuantizedDot.h.
+    Learning on the Neuron afterwards does not change the copy, quantize
+    it again for that.
+*/
+class QuantizedNeuron
+{
+    public:
+        QuantizedNeuron();
+        explicit QuantizedNeuron(const Neuron &neuron);
+        ~QuantizedNeuron();
+
+        void quantize(const Neuron &neuron); // Takes over the weights and activation function of the neuron
+
+        int getFeatureCount() const {return featureCount;}
+        float getWeightScale() const {return weightScale;}
+        float getBias() const {return bias;}
+        const int8_t* getWeights() const {return weights.getArray();}
+
+        float predict(const MatrixView<const float>& dataPoint); // Quantizes the data point (feature k at dataPoint[k][0]) on its own scale
+        void predictBatch(const QuantizedFeatureMatrix &featureMatrix, float* output); // Predicts every sample into output
+        void predictBatch(const Matrix<float> &featureMatrix, float* output); // Same, quantizing the features first
+
+        EActivationFunction activationFunctionEnum;
+        bool approximateActivation;
+
+    private:
+        bool validateFeatureCount(int dataFeatureCount);
+
+        int featureCount;
+        float weightScale;
+        float bias;
+        Array<int8_t> weights;
+        Array<int8_t> quantizedDataPoint; // Buffer of predict
+        QuantizedFeatureMatrix quantizedFeatures; // Buffer of predictBatch on float features
+};
+
+#endif // QUANTIZEDNEURON_H
@@ -0,0 +1,96 @@
+#include "SampleReader.h"
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+
+BinaryFileSampleReader::BinaryFileSampleReader(const std::string &featurePath, const std::string &classificationPath)
+{
+    uint64_t featureSizeX, featureSizeY, classificationSizeX, classificationSizeY;
+    uint32_t featureLayout, classificationLayout;
+    featureFile = openBinaryFile(featurePath, BinaryDataType<float>::value, sizeof(float), featureSizeX, featureSizeY, featureLayout);
+    if (featureLayout != BINARY_COLUMN_MAJOR)
+    {
+        close(featureFile);
+        throw std::runtime_error("BinaryFileSampleReader: " + featurePath + " is not a feature-major matrix");
+    }
+    try
+    {
+        classificationFile = openBinaryFile(classificationPath, BinaryDataType<float>::value, sizeof(float), classificationSizeX, classificationSizeY, classificationLayout);
+    }
+    catch (...)
+    {
+        close(featureFile);
+        throw;
+    }
+
+    if (classificationSizeY != 1 || classificationSizeX != featureSizeY || featureSizeX > INT_MAX)
+    {
+        close(featureFile);
+        close(classificationFile);
+        throw std::runtime_error("BinaryFileSampleReader: The classification vector must hold one value per sample of the feature matrix");
+    }
+
+    dimensionality = (int) featureSizeX;
+    sampleCount = (long long) featureSizeY;
+    position = 0;
+}
+
+BinaryFileSampleReader::~BinaryFileSampleReader()
+{
+    close(featureFile);
+    close(classificationFile);
+}
+
+int BinaryFileSampleReader::read(Matrix<float> &featureChunk, Array<float> &classificationChunk)
+{
+    long long remaining = sampleCount - position;
+    int count = remaining < featureChunk.getSizeY() ? (int) remaining : featureChunk.getSizeY();
+    if (count <= 0)
+        return 0;
+
+    // Every feature is a contiguous run of samples in the file
+    for (int k = 0; k < dimensionality; k++)
+        if (!readBinaryElements(featureFile, (uint64_t) k * sampleCount + position, count, sizeof(float), featureChunk[k]))
+            return -1;
+    if (!readBinaryElements(classificationFile, position, count, sizeof(float), classificationChunk.getArray()))
+        return -1;
+
+    position += count;
+    return count;
+}
+
+MappedSampleReader::MappedSampleReader(const std::string &featurePath, const std::string &classificationPath)
+    : featureMatrix(featurePath), classificationVector(classificationPath)
+{
+    if (featureMatrix.getLayout() != FEATURE_MAJOR)
+        throw std::runtime_error("MappedSampleReader: " + featurePath + " is not a feature-major matrix");
+    if (classificationVector.size() != featureMatrix.getSizeY())
+        throw std::runtime_error("MappedSampleReader: The classification vector must hold one value per sample of the feature matrix");
+    position = 0;
+}
+
+MappedSampleReader::~MappedSampleReader()
+{
+
+}
+
+int MappedSampleReader::read(Matrix<float> &featureChunk, Array<float> &classificationChunk)
+{
+    int remaining = featureMatrix.getSizeY() - position;
+    int count = remaining < featureChunk.getSizeY() ? remaining : featureChunk.getSizeY();
+    if (count <= 0)
+        return 0;
+
+    for (int k = 0; k < featureMatrix.getSizeX(); k++)
+    {
+        const float* source = featureMatrix[k] + position;
+        memcpy(featureChunk[k], source, count * sizeof(float));
+        releaseMappedPages(source, count * sizeof(float));
+    }
+    const float* source = classificationVector.getArray() + position;
+    memcpy(classificationChunk.getArray(), source, count * sizeof(float));
+    releaseMappedPages(source, count * sizeof(float));
+
+    position += count;
+    return count;
+}
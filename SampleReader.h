@@ -0,0 +1,77 @@
+#ifndef SAMPLEREADER_H
+#define SAMPLEREADER_H
+
+#include <string>
+
+#include "Matrix.h"
+#include "Array.h"
+
+/**
+    Source of training samples for Neuron::streamingLearning, which pulls
+    the data set in fixed-size chunks instead of holding it in memory.
+*/
+class SampleReader
+{
+    public:
+        virtual ~SampleReader(){}
+
+        virtual int getDimensionality() = 0; // Features per sample
+
+        /**
+        Fills the first samples of the chunk, featureChunk[feature][sample]
+        and classificationChunk[sample], with up to featureChunk.getSizeY()
+        samples following the ones read last. Returns how many were read,
+        0 at the end of the data set and -1 on a read error.
+        */
+        virtual int read(Matrix<float> &featureChunk, Array<float> &classificationChunk) = 0;
+
+        virtual void rewind() = 0; // Starts over at the first sample
+};
+
+/**
+    Reads chunks from a feature matrix file and a classification vector
+    file in the binary format of Matrix::save and Array::save, with one
+    positioned read per feature and chunk. The feature matrix must have been
+    saved feature-major. Throws std::runtime_error if the files cannot be
+    opened or do not belong together.
+*/
+class BinaryFileSampleReader : public SampleReader
+{
+    public:
+        BinaryFileSampleReader(const std::string &featurePath, const std::string &classificationPath);
+        ~BinaryFileSampleReader();
+
+        int getDimensionality() {return dimensionality;}
+        int read(Matrix<float> &featureChunk, Array<float> &classificationChunk);
+        void rewind() {position = 0;}
+
+    private:
+        int featureFile;
+        int classificationFile;
+        int dimensionality;
+        long long sampleCount;
+        long long position;
+};
+
+/**
+    Copies chunks out of memory-mapped binary files. The pages of every
+    chunk are released once copied so the resident size stays bounded by
+    the chunks, not by the file size.
+*/
+class MappedSampleReader : public SampleReader
+{
+    public:
+        MappedSampleReader(const std::string &featurePath, const std::string &classificationPath);
+        ~MappedSampleReader();
+
+        int getDimensionality() {return featureMatrix.getSizeX();}
+        int read(Matrix<float> &featureChunk, Array<float> &classificationChunk);
+        void rewind() {position = 0;}
+
+    private:
+        Matrix<float> featureMatrix;
+        Array<float> classificationVector;
+        int position;
+};
+
+#endif // SAMPLEREADER_H
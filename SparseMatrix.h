@@ -0,0 +1,126 @@
+#ifndef SPARSEMATRIX_H_INCLUDED
+#define SPARSEMATRIX_H_INCLUDED
+
+#include <string>
+#include <stdexcept>
+#include <iostream>
+
+#include "Matrix.h"
+#include "Array.h"
+
+/**
+    Sparse feature matrix in compressed sparse row (CSR) form: one row per
+    sample, holding the feature indices and values of its non-zero
+    features only. Memory use is proportional to the number of non-zeros,
+    not to featureCount * sampleCount, so data sets of millions of hashed
+    features fit in memory.
+    Like Matrix, copying a sparse matrix shares its storage.
+*/
+template <class T>
+class SparseMatrix
+{
+    int featureCount = 0;
+    Array<int> rowOffsets; // The non-zeros of sample j are rowOffsets[j] to rowOffsets[j + 1] - 1
+    Array<int> featureIndices;
+    Array<T> values;
+
+    public:
+        SparseMatrix(){rowOffsets.push_back(0);}
+        explicit SparseMatrix(int _featureCount) : featureCount(_featureCount) {rowOffsets.push_back(0);}
+
+        /**
+        Keeps the non-zeros of a dense feature matrix, in either layout
+        */
+        explicit SparseMatrix(const Matrix<T> &matrix) : featureCount(matrix.getFeatureCount())
+        {
+            rowOffsets.reserve(matrix.getSampleCount() + 1);
+            rowOffsets.push_back(0);
+            const T* elements = matrix.getArrayRef();
+            long long featureStride = matrix.getFeatureStride();
+            long long sampleStride = matrix.getSampleStride();
+            for (int j = 0; j < matrix.getSampleCount(); j++)
+            {
+                const T* sample = elements + j * sampleStride;
+                for (int k = 0; k < featureCount; k++)
+                    if (sample[k * featureStride] != 0)
+                    {
+                        featureIndices.push_back(k);
+                        values.push_back(sample[k * featureStride]);
+                    }
+                rowOffsets.push_back(values.size());
+            }
+        }
+        ~SparseMatrix(){};
+
+        int getFeatureCount() const {return featureCount;}
+        int getSampleCount() const {return rowOffsets.size() - 1;}
+        int getNonZeroCount() const {return values.size();}
+
+        /**
+        Makes room for sampleCount samples holding nonZeroCount non-zeros
+        in total, so adding them never reallocates
+        */
+        void reserve(int sampleCount, int nonZeroCount)
+        {
+            rowOffsets.reserve(sampleCount + 1);
+            featureIndices.reserve(nonZeroCount);
+            values.reserve(nonZeroCount);
+        }
+
+        /**
+        Appends a sample given its non-zero features, preferably in
+        ascending index order so that the weights are swept forward.
+        Throws std::invalid_argument for an index outside the features.
+        */
+        void addSample(const int* indices, const T* sampleValues, int count)
+        {
+            for (int n = 0; n < count; n++)
+                if (indices[n] < 0 || indices[n] >= featureCount)
+                {
+                    std::cout << "SparseMatrix: feature index " << indices[n] << " is outside of the " << featureCount << " features" << std::endl;
+                    throw std::invalid_argument("SparseMatrix: feature index out of range");
+                }
+
+            for (int n = 0; n < count; n++)
+            {
+                featureIndices.push_back(indices[n]);
+                values.push_back(sampleValues[n]);
+            }
+            rowOffsets.push_back(values.size());
+        }
+
+        /// Non-zeros of a sample
+        int getSampleNonZeroCount(int sample) const {return rowOffsets[sample + 1] - rowOffsets[sample];}
+        const int* getSampleIndices(int sample) const {return featureIndices.getArray() + rowOffsets[sample];}
+        const T* getSampleValues(int sample) const {return values.getArray() + rowOffsets[sample];}
+
+        /**
+        Dense, feature-major copy of the matrix
+        */
+        Matrix<T> toDense() const
+        {
+            Matrix<T> matrix(featureCount, getSampleCount());
+            matrix.fill(0);
+            for (int j = 0; j < getSampleCount(); j++)
+            {
+                const int* indices = getSampleIndices(j);
+                const T* sampleValues = getSampleValues(j);
+                for (int n = 0; n < getSampleNonZeroCount(j); n++)
+                    matrix[indices[n]][j] = sampleValues[n];
+            }
+            return matrix;
+        }
+
+        /**
+        Removes every sample, keeping the storage for new ones
+        */
+        void clear()
+        {
+            rowOffsets.setSize(1);
+            rowOffsets[0] = 0;
+            featureIndices.setSize(0);
+            values.setSize(0);
+        }
+};
+
+#endif // SPARSEMATRIX_H_INCLUDED
@@ -0,0 +1,149 @@
+#include "Storage.h"
+#include <stdlib.h>
+#include <new>
+
+static const int storageAlignment = 64;
+static const int sizeClassCount = 16; // 64 bytes to 2 MB
+static const size_t maxCachedBytes = 4 << 20; // Per size class and thread
+
+/**
+Free lists of one thread. The lists are linked through the first bytes
+of the cached blocks themselves.
+*/
+struct StoragePool
+{
+    void* freeLists[sizeClassCount];
+    int freeCounts[sizeClassCount];
+    StorageStatistics statistics;
+
+    StoragePool()
+    {
+        for (int c = 0; c < sizeClassCount; c++)
+        {
+            freeLists[c] = nullptr;
+            freeCounts[c] = 0;
+        }
+        statistics = StorageStatistics();
+    }
+
+    ~StoragePool();
+};
+
+// Blocks can still be released after the pool of a thread is gone, e.g.
+// by static destructors, so its state is tracked with a trivial flag
+enum EPoolState {POOL_UNUSED, POOL_ALIVE, POOL_DESTROYED};
+static thread_local EPoolState poolState = POOL_UNUSED;
+static thread_local StoragePool pool;
+
+StoragePool::~StoragePool()
+{
+    for (int c = 0; c < sizeClassCount; c++)
+        while (freeLists[c])
+        {
+            void* block = freeLists[c];
+            freeLists[c] = *(void**) block;
+            free(block);
+        }
+    poolState = POOL_DESTROYED;
+}
+
+static StoragePool* getPool()
+{
+    if (poolState == POOL_DESTROYED)
+        return nullptr;
+    poolState = POOL_ALIVE;
+    return &pool;
+}
+
+/**
+Smallest class holding the bytes, sizeClassCount if none does
+*/
+static int getSizeClass(size_t bytes)
+{
+    int sizeClass = 0;
+    size_t classBytes = storageAlignment;
+    while (classBytes < bytes && sizeClass < sizeClassCount)
+    {
+        classBytes <<= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+static void* allocateAligned(size_t bytes)
+{
+    // aligned_alloc wants a multiple of the alignment
+    bytes = (bytes + storageAlignment - 1) / storageAlignment * storageAlignment;
+    void* block = aligned_alloc(storageAlignment, bytes ? bytes : storageAlignment);
+    if (!block)
+        throw std::bad_alloc();
+    return block;
+}
+
+void* allocateStorageBlock(size_t bytes)
+{
+    StoragePool* localPool = getPool();
+    int sizeClass = getSizeClass(bytes);
+    size_t classBytes = sizeClass < sizeClassCount ? (size_t) storageAlignment << sizeClass : bytes;
+    void* block = nullptr;
+
+    if (localPool)
+    {
+        StorageStatistics &statistics = localPool->statistics;
+        statistics.allocations++;
+        statistics.bytes += classBytes;
+        if (statistics.bytes > statistics.peakBytes)
+            statistics.peakBytes = statistics.bytes;
+
+        if (sizeClass < sizeClassCount && localPool->freeLists[sizeClass])
+        {
+            block = localPool->freeLists[sizeClass];
+            localPool->freeLists[sizeClass] = *(void**) block;
+            localPool->freeCounts[sizeClass]--;
+            statistics.poolHits++;
+            return block;
+        }
+    }
+
+    return allocateAligned(classBytes);
+}
+
+void releaseStorageBlock(void* block, size_t bytes)
+{
+    StoragePool* localPool = getPool();
+    int sizeClass = getSizeClass(bytes);
+    size_t classBytes = sizeClass < sizeClassCount ? (size_t) storageAlignment << sizeClass : bytes;
+
+    if (!localPool)
+    {
+        free(block);
+        return;
+    }
+
+    localPool->statistics.bytes -= classBytes;
+    if (sizeClass < sizeClassCount && (localPool->freeCounts[sizeClass] == 0 || (localPool->freeCounts[sizeClass] + 1) * classBytes <= maxCachedBytes))
+    {
+        *(void**) block = localPool->freeLists[sizeClass];
+        localPool->freeLists[sizeClass] = block;
+        localPool->freeCounts[sizeClass]++;
+    }
+    else
+        free(block);
+}
+
+StorageStatistics getStorageStatistics()
+{
+    StoragePool* localPool = getPool();
+    return localPool ? localPool->statistics : StorageStatistics();
+}
+
+void resetStorageStatistics()
+{
+    StoragePool* localPool = getPool();
+    if (!localPool)
+        return;
+    long long bytes = localPool->statistics.bytes;
+    localPool->statistics = StorageStatistics();
+    localPool->statistics.bytes = bytes;
+    localPool->statistics.peakBytes = bytes;
+}
@@ -0,0 +1,75 @@
+#ifndef STORAGE_H_INCLUDED
+#define STORAGE_H_INCLUDED
+
+#include <stddef.h>
+#include <memory>
+#include <type_traits>
+
+/**
+    Element storage of Matrix and Array.
+
+    Buffers come from a pool owned by the calling thread instead of the
+    global heap: sizes are rounded up to a power of two size class and a
+    released buffer is kept on its class's free list for the next request
+    of that class, so threads that keep resizing small matrices neither
+    call malloc nor contend with each other. Buffers above the largest
+    class go straight to the system. Every buffer is 64 byte aligned.
+
+    A buffer released on another thread than the one it was allocated on
+    joins the releasing thread's pool.
+*/
+void* allocateStorageBlock(size_t bytes);
+void releaseStorageBlock(void* block, size_t bytes);
+
+/**
+    Allocation statistics of the calling thread's pool, releases being
+    counted on the thread that releases
+*/
+struct StorageStatistics
+{
+    long long allocations; // Buffers handed out
+    long long poolHits; // Of which served from a free list
+    long long bytes; // Bytes currently handed out
+    long long peakBytes; // Highest value of bytes since the last reset
+};
+
+StorageStatistics getStorageStatistics();
+void resetStorageStatistics(); // Zeroes the counters, the peak restarts at the current bytes
+
+/**
+    Standard allocator on top of the pool, used for the shared_ptr
+    control blocks so that they do not reach the global heap either
+*/
+template <class U>
+struct StorageAllocator
+{
+    typedef U value_type;
+
+    StorageAllocator() {}
+    template <class V> StorageAllocator(const StorageAllocator<V>&) {}
+
+    U* allocate(size_t count) {return (U*) allocateStorageBlock(count * sizeof(U));}
+    void deallocate(U* block, size_t count) {releaseStorageBlock(block, count * sizeof(U));}
+
+    template <class V> bool operator == (const StorageAllocator<V>&) const {return true;}
+    template <class V> bool operator != (const StorageAllocator<V>&) const {return false;}
+};
+
+/**
+    Uninitialised storage for count elements. Types that need constructing
+    or destroying keep using new T[].
+*/
+template <class T>
+std::shared_ptr<T[]> allocateStorage(long long count)
+{
+    if constexpr (std::is_trivial<T>::value)
+    {
+        size_t bytes = (size_t) count * sizeof(T);
+        T* block = (T*) allocateStorageBlock(bytes);
+        return std::shared_ptr<T[]>(block, [bytes](T* released){releaseStorageBlock(released, bytes);}, StorageAllocator<T>());
+    }
+    else
+        return std::shared_ptr<T[]>(new T[count]);
+}
+
+#endif // STORAGE_H_INCLUDED
@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+{
+    this->threadCount = threadCount < 1 ? 1 : threadCount;
+    taskFunction = nullptr;
+    taskObject = nullptr;
+    generation = 0;
+    pendingWorkers = 0;
+    stopping = false;
+
+    for (int i = 1; i < this->threadCount; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::runTask(void (*function)(void*, int), void* task)
+{
+    if (workers.empty())
+    {
+        function(task, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        taskFunction = function;
+        taskObject = task;
+        pendingWorkers = (int) workers.size();
+        generation++;
+    }
+    taskReady.notify_all();
+
+    // The calling thread takes index 0
+    function(task, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    taskDone.wait(lock, [this]{return pendingWorkers == 0;});
+}
+
+void ThreadPool::workerLoop(int threadIndex)
+{
+    long long seenGeneration = 0;
+    while (true)
+    {
+        void (*function)(void*, int);
+        void* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [&]{return stopping || generation != seenGeneration;});
+            if (stopping)
+                return;
+            seenGeneration = generation;
+            function = taskFunction;
+            task = taskObject;
+        }
+
+        function(task, threadIndex);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingWorkers == 0)
+            taskDone.notify_one();
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+    Fixed size pool of worker threads that all run the same task.
+    run(task) calls task(threadIndex) once on every thread of the pool,
+    index 0 being the calling thread, and returns when all have finished,
+    so consecutive runs are separated by a barrier.
+    The task is passed by reference, running it does not allocate.
+*/
+class ThreadPool
+{
+    public:
+        ThreadPool(int threadCount);
+        ~ThreadPool();
+
+        int getThreadCount() const {return threadCount;}
+
+        template <class Task>
+        void run(Task &task)
+        {
+            runTask(&invokeTask<Task>, &task);
+        }
+
+    private:
+        template <class Task>
+        static void invokeTask(void* task, int threadIndex)
+        {
+            (*static_cast<Task*>(task))(threadIndex);
+        }
+
+        void runTask(void (*function)(void*, int), void* task);
+        void workerLoop(int threadIndex);
+
+        int threadCount;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable taskReady;
+        std::condition_variable taskDone;
+        void (*taskFunction)(void*, int);
+        void* taskObject;
+        long long generation; // Incremented for every run, wakes the workers
+        int pendingWorkers;
+        bool stopping;
+};
+
+#endif // THREADPOOL_H_INCLUDED
@@ -0,0 +1,155 @@
+#include "Transpose.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRANSPOSE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+    Register kernel: transposes the N x N block at source into destination
+*/
+template <class T, int N>
+static void kernelPortable(const T* source, long long sourceStride, T* destination, long long destinationStride)
+{
+    for (int x = 0; x < N; x++)
+        for (int y = 0; y < N; y++)
+            destination[y * destinationStride + x] = source[x * sourceStride + y];
+}
+
+#ifdef TRANSPOSE_X86_KERNELS
+
+/// AVX, 8 x 8 floats: unpack pairs, shuffle quads, swap 128 bit lanes
+__attribute__((target("avx")))
+static void kernelFloatAvx(const float* source, long long sourceStride, float* destination, long long destinationStride)
+{
+    __m256 r0 = _mm256_loadu_ps(source);
+    __m256 r1 = _mm256_loadu_ps(source + sourceStride);
+    __m256 r2 = _mm256_loadu_ps(source + 2 * sourceStride);
+    __m256 r3 = _mm256_loadu_ps(source + 3 * sourceStride);
+    __m256 r4 = _mm256_loadu_ps(source + 4 * sourceStride);
+    __m256 r5 = _mm256_loadu_ps(source + 5 * sourceStride);
+    __m256 r6 = _mm256_loadu_ps(source + 6 * sourceStride);
+    __m256 r7 = _mm256_loadu_ps(source + 7 * sourceStride);
+
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+    _mm256_storeu_ps(destination, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(destination + destinationStride, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(destination + 2 * destinationStride, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(destination + 3 * destinationStride, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(destination + 4 * destinationStride, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(destination + 5 * destinationStride, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(destination + 6 * destinationStride, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(destination + 7 * destinationStride, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+/// AVX, 4 x 4 doubles
+__attribute__((target("avx")))
+static void kernelDoubleAvx(const double* source, long long sourceStride, double* destination, long long destinationStride)
+{
+    __m256d r0 = _mm256_loadu_pd(source);
+    __m256d r1 = _mm256_loadu_pd(source + sourceStride);
+    __m256d r2 = _mm256_loadu_pd(source + 2 * sourceStride);
+    __m256d r3 = _mm256_loadu_pd(source + 3 * sourceStride);
+
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(destination, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(destination + destinationStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(destination + 2 * destinationStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(destination + 3 * destinationStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+#endif // TRANSPOSE_X86_KERNELS
+
+template <class T>
+struct TransposeKernel
+{
+    const char* name;
+    int size; // N of the N x N register kernel
+    void (*kernel)(const T* source, long long sourceStride, T* destination, long long destinationStride);
+};
+
+static TransposeKernel<float> selectFloatKernel()
+{
+#ifdef TRANSPOSE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return {"avx", 8, kernelFloatAvx};
+#endif
+    return {"portable", 8, kernelPortable<float, 8>};
+}
+
+static TransposeKernel<double> selectDoubleKernel()
+{
+#ifdef TRANSPOSE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return {"avx", 4, kernelDoubleAvx};
+#endif
+    return {"portable", 4, kernelPortable<double, 4>};
+}
+
+static const TransposeKernel<float>& floatKernel()
+{
+    static const TransposeKernel<float> kernel = selectFloatKernel();
+    return kernel;
+}
+
+static const TransposeKernel<double>& doubleKernel()
+{
+    static const TransposeKernel<double> kernel = selectDoubleKernel();
+    return kernel;
+}
+
+/**
+    Whole N x N blocks go through the register kernel, the edges element by element
+*/
+template <class T>
+static void kernelTile(const TransposeKernel<T>& kernel, int sizeX, int sizeY, const T* source, long long sourceStride, T* destination, long long destinationStride)
+{
+    int n = kernel.size;
+    int fullX = sizeX / n * n;
+    int fullY = sizeY / n * n;
+    for (int x = 0; x < fullX; x += n)
+        for (int y = 0; y < fullY; y += n)
+            kernel.kernel(source + x * sourceStride + y, sourceStride, destination + y * destinationStride + x, destinationStride);
+
+    for (int x = 0; x < sizeX; x++)
+        for (int y = (x < fullX ? fullY : 0); y < sizeY; y++)
+            destination[y * destinationStride + x] = source[x * sourceStride + y];
+}
+
+void transposeTile(int sizeX, int sizeY, const float* source, long long sourceStride, float* destination, long long destinationStride)
+{
+    kernelTile(floatKernel(), sizeX, sizeY, source, sourceStride, destination, destinationStride);
+}
+
+void transposeTile(int sizeX, int sizeY, const double* source, long long sourceStride, double* destination, long long destinationStride)
+{
+    kernelTile(doubleKernel(), sizeX, sizeY, source, sourceStride, destination, destinationStride);
+}
+
+const char* getTransposeKernelName()
+{
+    return floatKernel().name;
+}
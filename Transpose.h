@@ -0,0 +1,115 @@
+#ifndef TRANSPOSE_H_INCLUDED
+#define TRANSPOSE_H_INCLUDED
+
+#include <vector>
+#include <stdint.h>
+#include <utility>
+
+/**
+    Matrix transposition in the Matrix storage layout.
+
+    A sizeX x sizeY source is sizeX runs of sizeY contiguous elements, run x
+    starting at x * sourceStride. Its transpose is sizeY runs of sizeX
+    elements: destination[y * destinationStride + x] = source[x * sourceStride + y].
+    Switching a feature matrix between featureMatrix[feature][sample] and
+    [sample][feature] is exactly this operation.
+
+    The out-of-place transpose is cache-oblivious: it halves the longer
+    side until a block fits a 32 x 32 tile, so every level of the cache
+    hierarchy sees blocks that fit it without tuning. Float tiles are
+    transposed with 8 x 8 AVX register kernels and double tiles with 4 x 4
+    ones when the CPU has AVX, chosen once at runtime.
+*/
+const int transposeTileSize = 32;
+
+// Transposes one tile of at most transposeTileSize x transposeTileSize elements
+void transposeTile(int sizeX, int sizeY, const float* source, long long sourceStride, float* destination, long long destinationStride);
+void transposeTile(int sizeX, int sizeY, const double* source, long long sourceStride, double* destination, long long destinationStride);
+
+template <class T>
+void transposeTile(int sizeX, int sizeY, const T* source, long long sourceStride, T* destination, long long destinationStride)
+{
+    for (int x = 0; x < sizeX; x++)
+        for (int y = 0; y < sizeY; y++)
+            destination[y * destinationStride + x] = source[x * sourceStride + y];
+}
+
+const char* getTransposeKernelName(); // Name of the float tile kernel chosen for this CPU
+
+/**
+    Out-of-place transpose, source and destination must not overlap
+*/
+template <class T>
+void transpose(int sizeX, int sizeY, const T* source, long long sourceStride, T* destination, long long destinationStride)
+{
+    if (sizeX <= transposeTileSize && sizeY <= transposeTileSize)
+    {
+        transposeTile(sizeX, sizeY, source, sourceStride, destination, destinationStride);
+        return;
+    }
+
+    // Split the longer side, keeping the halves multiples of the register kernels
+    if (sizeX >= sizeY)
+    {
+        int half = sizeX / 2 / 8 * 8;
+        transpose(half, sizeY, source, sourceStride, destination, destinationStride);
+        transpose(sizeX - half, sizeY, source + half * sourceStride, sourceStride, destination + half, destinationStride);
+    }
+    else
+    {
+        int half = sizeY / 2 / 8 * 8;
+        transpose(sizeX, half, source, sourceStride, destination, destinationStride);
+        transpose(sizeX, sizeY - half, source + half, sourceStride, destination + half * destinationStride, destinationStride);
+    }
+}
+
+/**
+    In-place transpose of a contiguous sizeX x sizeY matrix (stride sizeY),
+    leaving a contiguous sizeY x sizeX one.
+
+    Square matrices swap mirrored tiles. Other shapes follow the cycles of
+    the permutation x * sizeY + y -> y * sizeX + x, marking visited elements
+    in a bitmap of size / 8 bytes, which is the only extra memory used.
+    Cycle following jumps across the whole matrix, so it is far slower
+    than the out-of-place transpose and meant for matrices that cannot be
+    held twice in memory.
+*/
+template <class T>
+void transposeInPlace(int sizeX, int sizeY, T* data)
+{
+    long long size = (long long) sizeX * sizeY;
+    if (size < 2)
+        return;
+
+    if (sizeX == sizeY)
+    {
+        int n = sizeX;
+        for (int x0 = 0; x0 < n; x0 += transposeTileSize)
+            for (int y0 = x0; y0 < n; y0 += transposeTileSize)
+                for (int x = x0; x < x0 + transposeTileSize && x < n; x++)
+                    for (int y = (y0 == x0 ? x + 1 : y0); y < y0 + transposeTileSize && y < n; y++)
+                        std::swap(data[(long long) x * n + y], data[(long long) y * n + x]);
+        return;
+    }
+
+    // The first and the last element stay where they are
+    std::vector<uint64_t> visited((size + 63) / 64, 0);
+    for (long long start = 1; start < size - 1; start++)
+    {
+        if (visited[start / 64] & (1ull << (start % 64)))
+            continue;
+
+        // Carry the element of each position to where it belongs until the cycle closes
+        long long position = start;
+        T carried = data[start];
+        do
+        {
+            long long next = position % sizeY * sizeX + position / sizeY;
+            std::swap(carried, data[next]);
+            visited[next / 64] |= 1ull << (next % 64);
+            position = next;
+        } while (position != start);
+    }
+}
+
+#endif // TRANSPOSE_H_INCLUDED
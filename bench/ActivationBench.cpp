@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include <string>
+
+#include "../Neuron.h"
+
+/**
+    Maximum error of the FastMath.h approximations on a dense grid
+    (the documented bounds were measured over every float)
+*/
+BENCHMARK(fastMathError)
+{
+    double expError = 0, tanhError = 0, atanError = 0;
+    for (int i = 0; i <= 20000000; i++)
+    {
+        float x = (float) (-87.0 + 175.0 * i / 20000000.0);
+        double expValue = exp((double) x);
+        double error = fabs(fastExp(x) - expValue) / expValue;
+        expError = error > expError ? error : expError;
+
+        float y = (float) (-20.0 + 40.0 * i / 20000000.0);
+        error = fabs(fastTanh(y) - tanh((double) y));
+        tanhError = error > tanhError ? error : tanhError;
+        error = fabs(fastAtan(y) - atan((double) y));
+        atanError = error > atanError ? error : atanError;
+    }
+
+    reportResult("exp.max_relative_error", expError, "");
+    reportResult("tanh.max_absolute_error", tanhError, "");
+    reportResult("atan.max_absolute_error", atanError, "");
+    if (expError > 1e-7 || tanhError > 1.5e-7 || atanError > 2e-6)
+        reportFailure("an approximation exceeds its documented maximum error");
+}
+
+/**
+    Array at a time activation over 1M values, libm against approximations
+*/
+BENCHMARK(activationArrayThroughput)
+{
+    const int count = 1 << 20;
+    const int repetitions = 20;
+    Array<float> input(count), values(count);
+    for (int i = 0; i < count; i++)
+        input[i] = (i % 2001 - 1000) / 100.0f;
+
+    EActivationFunction activations[] = {LOGISTIC, TANH01, ARCTAN01, GAUSSIAN, RECTIFIED_LINEAR_UNIT};
+    const char* names[] = {"logistic", "tanh01", "arctan01", "gaussian", "relu"};
+    for (int a = 0; a < 5; a++)
+    {
+        for (int approximate = 0; approximate < 2; approximate++)
+        {
+            Neuron neuron;
+            neuron.activationFunctionEnum = activations[a];
+            neuron.approximateActivation = approximate == 1;
+
+            double seconds = 0;
+            for (int r = 0; r < repetitions; r++)
+            {
+                memcpy(values.getArray(), input.getArray(), count * sizeof(float));
+                BenchmarkTimer timer;
+                neuron.activationFunction(values.getArray(), count);
+                seconds += timer.seconds();
+            }
+
+            std::string name = std::string(names[a]) + (approximate ? ".approximate" : ".exact");
+            reportResult(name + ".values_per_second", count * (double) repetitions / seconds, "values/s");
+        }
+    }
+}
+
+/**
+    predictBatch on 1M samples with the TANH01 activation of main.cpp,
+    exact against approximate
+*/
+BENCHMARK(predictBatchApproximateActivation)
+{
+    const int samples = 1000000;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, 2, featureMatrix, classificationVector, 7);
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.deltaLearning(featureMatrix, classificationVector, 1, 0.5f);
+
+    Array<float> exact(samples), approximate(samples);
+    BenchmarkTimer timer;
+    perceptron.predictBatch(featureMatrix, exact.getArray());
+    double exactSeconds = timer.seconds();
+
+    perceptron.approximateActivation = true;
+    timer.reset();
+    perceptron.predictBatch(featureMatrix, approximate.getArray());
+    double approximateSeconds = timer.seconds();
+
+    int disagreements = 0;
+    for (int i = 0; i < samples; i++)
+        if (roundf(exact[i]) != roundf(approximate[i]))
+            disagreements++;
+
+    reportResult("exact.samples_per_second", samples / exactSeconds, "samples/s");
+    reportResult("approximate.samples_per_second", samples / approximateSeconds, "samples/s");
+    reportResult("rounded_disagreements", disagreements, "samples");
+}
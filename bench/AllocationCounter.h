@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H_INCLUDED
+#define ALLOCATIONCOUNTER_H_INCLUDED
+
+/**
+    Counts every call to the global operator new made by the benchmark
+    binary, plus the Matrix and Array buffers the calling thread took from
+    its storage pool (see Storage.h). Used to prove that hot loops do not
+    allocate.
+*/
+long long getAllocationCount();
+
+#endif // ALLOCATIONCOUNTER_H_INCLUDED
@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+
+#include "../Array.h"
+
+#include <string>
+#include <vector>
+
+/**
+    Building a 10M element label vector by appending, with push_back and
+    with insert at the end, against std::vector
+*/
+BENCHMARK(arrayAppend)
+{
+    const int count = 10000000;
+
+    BenchmarkTimer timer;
+    Array<float> pushed;
+    for (int i = 0; i < count; i++)
+        pushed.push_back((float) (i & 1));
+    double pushSeconds = timer.seconds();
+
+    timer.reset();
+    Array<float> inserted;
+    for (int i = 0; i < count; i++)
+        inserted.insert((float) (i & 1), inserted.size());
+    double insertSeconds = timer.seconds();
+
+    timer.reset();
+    std::vector<float> vector;
+    for (int i = 0; i < count; i++)
+        vector.push_back((float) (i & 1));
+    double vectorSeconds = timer.seconds();
+
+    reportResult("push_back.elements_per_second", count / pushSeconds, "elements/s");
+    reportResult("insert_at_end.elements_per_second", count / insertSeconds, "elements/s");
+    reportResult("std_vector.elements_per_second", count / vectorSeconds, "elements/s");
+    if (pushed.size() != count || inserted.size() != count || pushed.capacity() < count)
+        reportFailure("the appended arrays have the wrong size");
+    for (int i = 0; i < count; i++)
+        if (pushed[i] != (float) (i & 1) || inserted[i] != (float) (i & 1))
+        {
+            reportFailure("appending stored wrong elements");
+            break;
+        }
+}
+
+/**
+    Insert and remove in the middle, on trivially copyable and on
+    non-trivially copyable elements, and on storage shared with a copy
+*/
+BENCHMARK(arrayInsertRemove)
+{
+    const int count = 20000;
+
+    BenchmarkTimer timer;
+    Array<int> front;
+    for (int i = 0; i < count; i++)
+        front.insert(i, 0);
+    reportResult("insert_at_front.elements_per_second", count / timer.seconds(), "elements/s");
+    for (int i = 0; i < count; i++)
+        if (front[i] != count - 1 - i)
+        {
+            reportFailure("inserting at the front stored wrong elements");
+            break;
+        }
+
+    // [0 .. 9] -> remove 2 and 5..7 -> [0 1 3 4 8 9] -> insert itself at 1
+    Array<std::string> strings;
+    for (int i = 0; i < 10; i++)
+        strings.push_back(std::to_string(i));
+    strings.remove(2);
+    strings.remove(4, 6);
+    strings.insert(strings, 1);
+    std::string joined;
+    for (int i = 0; i < strings.size(); i++)
+        joined += strings[i];
+    if (joined != "001348913489")
+        reportFailure("insert/remove of strings gave " + joined);
+
+    // A copy shares the storage and must not see later modifications
+    Array<int> original(4);
+    for (int i = 0; i < 4; i++)
+        original[i] = i;
+    Array<int> copy = original;
+    original.remove(0);
+    original.push_back(9);
+    if (copy.size() != 4 || copy[0] != 0 || copy[3] != 3 || original[0] != 1 || original[3] != 9)
+        reportFailure("modifying an array changed a copy sharing its storage");
+}
@@ -0,0 +1,257 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+
+struct RegisteredBenchmark
+{
+    const char* name;
+    BenchmarkFunction function;
+};
+
+struct BenchmarkResult
+{
+    std::string benchmark;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+static std::vector<RegisteredBenchmark>& registeredBenchmarks()
+{
+    static std::vector<RegisteredBenchmark> benchmarks; // Function local so registration order does not matter
+    return benchmarks;
+}
+
+static const char* currentBenchmark = "";
+static bool failed = false;
+static std::vector<BenchmarkResult> results;
+
+int registerBenchmark(const char* name, BenchmarkFunction function)
+{
+    registeredBenchmarks().push_back({name, function});
+    return (int) registeredBenchmarks().size();
+}
+
+void reportResult(const std::string& metric, double value, const std::string& unit)
+{
+    std::cout << currentBenchmark << "." << metric << " = " << value << " " << unit << std::endl;
+    results.push_back({currentBenchmark, metric, value, unit});
+}
+
+void reportFailure(const std::string& message)
+{
+    std::cout << currentBenchmark << ": FAILED: " << message << std::endl;
+    failed = true;
+}
+
+static std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+    One result per line so that readResults can read the file back
+    without a full JSON parser
+*/
+static bool writeResults(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "Cannot write the results to " << path << std::endl;
+        return false;
+    }
+
+    file.precision(17);
+    file << "{\n  \"format\": \"neuron_bench\",\n  \"version\": 1,\n  \"failed\": " << (failed ? "true" : "false") << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& result = results[i];
+        file << "    {\"benchmark\": " << jsonString(result.benchmark) << ", \"metric\": " << jsonString(result.metric)
+             << ", \"value\": " << result.value << ", \"unit\": " << jsonString(result.unit) << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return true;
+}
+
+/**
+    Value of "key": in a line written by writeResults, the string is
+    unescaped, numbers are returned as written
+*/
+static bool readField(const std::string& line, const std::string& key, std::string& value)
+{
+    std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos)
+        return false;
+    start += pattern.size();
+
+    value.clear();
+    if (line[start] != '"')
+    {
+        size_t end = line.find_first_of(",}", start);
+        value = line.substr(start, end - start);
+        return true;
+    }
+
+    for (size_t i = start + 1; i < line.size(); i++)
+    {
+        if (line[i] == '\\' && i + 1 < line.size())
+            value += line[++i];
+        else if (line[i] == '"')
+            return true;
+        else
+            value += line[i];
+    }
+    return false;
+}
+
+/**
+    Reads a file written by --json into results keyed by benchmark.metric
+*/
+static bool readResults(const std::string& path, std::map<std::string, BenchmarkResult>& fileResults)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "Cannot read the results of " << path << std::endl;
+        return false;
+    }
+
+    std::string line, value;
+    while (std::getline(file, line))
+    {
+        BenchmarkResult result;
+        if (!readField(line, "benchmark", result.benchmark) || !readField(line, "metric", result.metric)
+            || !readField(line, "value", value) || !readField(line, "unit", result.unit))
+            continue;
+        result.value = strtod(value.c_str(), nullptr);
+        fileResults[result.benchmark + "." + result.metric] = result;
+    }
+    return true;
+}
+
+/**
+    1 when a larger value is better (rates and speedups), -1 when a smaller
+    one is (times, allocations, bytes), 0 for values that are not compared
+    (accuracies, errors, kernel names)
+*/
+static int metricDirection(const std::string& unit)
+{
+    if (unit == "x" || (unit.size() > 2 && unit.compare(unit.size() - 2, 2, "/s") == 0))
+        return 1;
+    if (unit == "s" || unit == "ms" || unit == "us" || unit == "ns" || unit == "allocations" || unit == "bytes")
+        return -1;
+    return 0;
+}
+
+/**
+    Compares every metric of the current results with the baseline ones
+    and flags those that got worse by more than the threshold (a fraction)
+*/
+static int compareResults(const std::string& baselinePath, const std::string& currentPath, double threshold)
+{
+    std::map<std::string, BenchmarkResult> baseline, current;
+    if (!readResults(baselinePath, baseline) || !readResults(currentPath, current))
+        return 2;
+
+    int regressions = 0, compared = 0;
+    for (const auto& entry : current)
+    {
+        const BenchmarkResult& result = entry.second;
+        auto base = baseline.find(entry.first);
+        int direction = metricDirection(result.unit);
+        if (base == baseline.end() || direction == 0 || base->second.value == 0)
+            continue;
+
+        double change = (result.value - base->second.value) / base->second.value;
+        bool regressed = change * direction < -threshold;
+        compared++;
+        if (regressed)
+            regressions++;
+
+        std::cout << (regressed ? "REGRESSION " : "           ") << entry.first << ": " << base->second.value << " -> "
+                  << result.value << " " << result.unit << " (" << (change >= 0 ? "+" : "") << change * 100 << "%)" << std::endl;
+    }
+
+    for (const auto& entry : baseline)
+        if (current.find(entry.first) == current.end() && metricDirection(entry.second.unit) != 0)
+            std::cout << "MISSING    " << entry.first << std::endl;
+
+    std::cout << compared << " metrics compared, " << regressions << " regressed by more than " << threshold * 100 << "%" << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: neuron_bench [name filter] [--json results.json]" << std::endl
+              << "       neuron_bench --compare baseline.json current.json [--threshold 0.1]" << std::endl;
+}
+
+/**
+    Usage:
+    neuron_bench [name filter] [--json results.json]
+        Runs every registered benchmark whose name contains the filter,
+        optionally writing the results as JSON. The C library generator
+        is reseeded before every benchmark, so results do not depend on
+        which other benchmarks ran.
+    neuron_bench --compare baseline.json current.json [--threshold 0.1]
+        Lists the metrics of two JSON result files and exits with 1 if any
+        got worse by more than the threshold
+    Any other option, or an option missing its value, prints the usage and
+    exits with 2.
+*/
+int main(int argc, char* argv[])
+{
+    std::string filter, jsonPath, baselinePath, currentPath;
+    double threshold = 0.1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc)
+        {
+            baselinePath = argv[++i];
+            currentPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = strtod(argv[++i], nullptr);
+        else if (argv[i][0] == '-') // Benchmark names never start with a dash
+        {
+            printUsage();
+            return 2;
+        }
+        else
+            filter = argv[i];
+    }
+
+    if (!baselinePath.empty())
+        return compareResults(baselinePath, currentPath, threshold);
+
+    for (const RegisteredBenchmark& benchmark : registeredBenchmarks())
+    {
+        if (std::string(benchmark.name).find(filter) == std::string::npos)
+            continue;
+
+        currentBenchmark = benchmark.name;
+        std::cout << "### " << benchmark.name << " ###" << std::endl;
+        srand(1);
+        benchmark.function();
+    }
+
+    if (!jsonPath.empty() && !writeResults(jsonPath))
+        return 2;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+
+#include <chrono>
+#include <string>
+
+/**
+    Tiny benchmark harness.
+    Every benchmark registers itself through the BENCHMARK macro and is run
+    by bench/Benchmark.cpp, optionally filtered by name on the command line.
+*/
+typedef void (*BenchmarkFunction)();
+
+int registerBenchmark(const char* name, BenchmarkFunction function);
+void reportResult(const std::string& metric, double value, const std::string& unit);
+void reportFailure(const std::string& message); // Marks the run as failed, the process exits with 1
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static int name##Registration = registerBenchmark(#name, name); \
+    static void name()
+
+class BenchmarkTimer
+{
+    std::chrono::steady_clock::time_point start;
+
+    public:
+        BenchmarkTimer(){reset();}
+
+        void reset(){start = std::chrono::steady_clock::now();}
+
+        /**
+        Seconds elapsed since construction or the last reset
+        */
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+};
+
+#endif // BENCHMARK_H_INCLUDED
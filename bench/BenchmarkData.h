@@ -0,0 +1,63 @@
+#ifndef BENCHMARKDATA_H_INCLUDED
+#define BENCHMARKDATA_H_INCLUDED
+
+#include <random>
+
+#include "../Matrix.h"
+#include "../Array.h"
+
+/**
+    Same linearly separable problem as dataGenerator in main.cpp
+    (class 1 when x0 - x1 >= 0), generalised to any dimensionality and
+    driven by a seeded generator so runs are comparable.
+*/
+inline void generateLinearData(int numberOfSamples, int dimensionality, Matrix<float> &featureMatrix, Array<float> &classificationVector, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(-500, 500);
+
+    featureMatrix.setSize(dimensionality, numberOfSamples);
+    classificationVector.setSize(numberOfSamples);
+
+    for (int i = 0; i < numberOfSamples; i++)
+    {
+        for (int j = 0; j < dimensionality; j++)
+            featureMatrix[j][i] = (float) distribution(generator);
+
+        float difference = dimensionality > 1 ? featureMatrix[0][i] - featureMatrix[1][i] : featureMatrix[0][i];
+        classificationVector[i] = difference >= 0 ? 1.0f : 0.0f;
+    }
+}
+
+/**
+    Sparse binary features (each one set with the given density), labelled
+    by a hidden random linear model so that the problem stays learnable
+*/
+inline void generateSparseData(int numberOfSamples, int dimensionality, float density, Matrix<float> &featureMatrix, Array<float> &classificationVector, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    Array<float> hiddenWeights(dimensionality);
+    for (int j = 0; j < dimensionality; j++)
+        hiddenWeights[j] = normal(generator);
+
+    featureMatrix.setSize(dimensionality, numberOfSamples);
+    featureMatrix.fill(0);
+    classificationVector.setSize(numberOfSamples);
+
+    for (int i = 0; i < numberOfSamples; i++)
+    {
+        float sum = 0;
+        for (int j = 0; j < dimensionality; j++)
+            if (uniform(generator) < density)
+            {
+                featureMatrix[j][i] = 1;
+                sum += hiddenWeights[j];
+            }
+        classificationVector[i] = sum >= 0 ? 1.0f : 0.0f;
+    }
+}
+
+#endif // BENCHMARKDATA_H_INCLUDED
@@ -0,0 +1,197 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <string>
+
+static std::string temporaryPath(const char* name)
+{
+    return std::string(P_tmpdir) + "/" + name;
+}
+
+/**
+    Loading a feature matrix by parsing text element by element against
+    mapping the binary file, and training on the mapped matrix against
+    training on the one in memory
+*/
+BENCHMARK(binaryFileLoading)
+{
+    const int samples = 250000;
+    const int features = 16;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, features, featureMatrix, classificationVector, 11);
+
+    std::string textPath = temporaryPath("neuron_bench_features.txt");
+    std::string featurePath = temporaryPath("neuron_bench_features.bin");
+    std::string labelPath = temporaryPath("neuron_bench_labels.bin");
+    {
+        std::ofstream text(textPath);
+        for (int j = 0; j < samples; j++)
+            for (int k = 0; k < features; k++)
+                text << featureMatrix[k][j] << (k + 1 < features ? ' ' : '\n');
+    }
+    featureMatrix.save(featurePath);
+    classificationVector.save(labelPath);
+
+    /// Text parsing, the way the datasets were loaded so far
+    BenchmarkTimer timer;
+    Matrix<float> parsedMatrix(features, samples);
+    {
+        std::ifstream text(textPath);
+        for (int j = 0; j < samples; j++)
+            for (int k = 0; k < features; k++)
+                text >> parsedMatrix[k][j];
+    }
+    double parseSeconds = timer.seconds();
+
+    /// Mapping, followed by a first pass touching every page
+    timer.reset();
+    Matrix<float> mappedMatrix(featurePath);
+    Array<float> mappedLabels(labelPath);
+    double mapSeconds = timer.seconds();
+
+    timer.reset();
+    bool identical = mappedMatrix.getSizeX() == features && mappedMatrix.getSizeY() == samples && mappedLabels.size() == samples;
+    for (int k = 0; identical && k < features; k++)
+        for (int j = 0; j < samples; j++)
+            identical = identical && mappedMatrix[k][j] == featureMatrix[k][j];
+    for (int j = 0; identical && j < samples; j++)
+        identical = mappedLabels[j] == classificationVector[j];
+    double firstPassSeconds = timer.seconds();
+
+    reportResult("text_parse_seconds", parseSeconds, "s");
+    reportResult("map_seconds", mapSeconds, "s");
+    reportResult("mapped_first_pass_seconds", firstPassSeconds, "s");
+    if (!identical)
+        reportFailure("the mapped matrix differs from the saved one");
+
+    /// Training reads the mapped file the same way it reads memory
+    Neuron inMemory, mapped;
+    inMemory.activationFunctionEnum = mapped.activationFunctionEnum = TANH01;
+    inMemory.initWeightMatrix(features);
+    mapped.initWeightMatrix(features);
+    mapped.weightMatrix = inMemory.weightMatrix;
+    inMemory.deltaLearning(featureMatrix, classificationVector, 2, 0.5f);
+    mapped.deltaLearning(mappedMatrix, mappedLabels, 2, 0.5f);
+    for (int k = 0; k <= features; k++)
+        if (mapped.weightMatrix[k][0] != inMemory.weightMatrix[k][0])
+        {
+            reportFailure("training on the mapped matrix gives other weights");
+            break;
+        }
+
+    remove(textPath.c_str());
+    remove(featurePath.c_str());
+    remove(labelPath.c_str());
+}
+
+/**
+    A matrix and an array mapped from a file and saved back to that same
+    file: the save must not truncate the file under its own mapping, and
+    the mapped copies must keep their contents
+*/
+BENCHMARK(binaryFileSaveMapped)
+{
+    std::string matrixPath = temporaryPath("neuron_bench_resave_matrix.bin");
+    std::string arrayPath = temporaryPath("neuron_bench_resave_array.bin");
+    Matrix<float> original(1000, 1000);
+    for (int x = 0; x < 1000; x++)
+        for (int y = 0; y < 1000; y++)
+            original[x][y] = (float) (x - y);
+    Array<float> originalArray(100000);
+    for (int i = 0; i < originalArray.size(); i++)
+        originalArray[i] = (float) i;
+    original.save(matrixPath);
+    originalArray.save(arrayPath);
+
+    Matrix<float> mapped(matrixPath);
+    Array<float> mappedArray(arrayPath);
+    mapped.save(matrixPath);
+    mappedArray.save(arrayPath);
+
+    Matrix<float> remapped(matrixPath);
+    Array<float> remappedArray(arrayPath);
+    bool identical = remapped.getSizeX() == 1000 && remapped.getSizeY() == 1000 && remappedArray.size() == originalArray.size();
+    for (int x = 0; identical && x < 1000; x++)
+        for (int y = 0; y < 1000; y++)
+            identical = identical && mapped[x][y] == original[x][y] && remapped[x][y] == original[x][y];
+    for (int i = 0; identical && i < originalArray.size(); i++)
+        identical = mappedArray[i] == originalArray[i] && remappedArray[i] == originalArray[i];
+    if (!identical)
+        reportFailure("saving a mapped matrix or array over its own file changed it");
+
+    remove(matrixPath.c_str());
+    remove(arrayPath.c_str());
+}
+
+/**
+    A sample-major matrix must be mapped back sample-major, a feature-major
+    one feature-major
+*/
+BENCHMARK(binaryFileLayout)
+{
+    std::string path = temporaryPath("neuron_bench_layout.bin");
+    Matrix<float> featureMajor(30, 200);
+    for (int x = 0; x < 30; x++)
+        for (int y = 0; y < 200; y++)
+            featureMajor[x][y] = (float) (x * 200 + y);
+    Matrix<float> sampleMajor;
+    sampleMajor = featureMajor;
+    sampleMajor.transpose();
+
+    sampleMajor.save(path);
+    Matrix<float> mappedSampleMajor(path);
+    bool restored = mappedSampleMajor.getLayout() == SAMPLE_MAJOR && mappedSampleMajor.getFeatureCount() == 30
+                    && mappedSampleMajor.getSampleCount() == 200;
+    for (int j = 0; restored && j < 200; j++)
+        for (int k = 0; k < 30; k++)
+            restored = restored && mappedSampleMajor[j][k] == featureMajor[k][j];
+
+    featureMajor.save(path);
+    Matrix<float> mappedFeatureMajor(path);
+    restored = restored && mappedFeatureMajor.getLayout() == FEATURE_MAJOR && mappedFeatureMajor.getFeatureCount() == 30;
+    if (!restored)
+        reportFailure("a saved matrix was mapped back with another layout");
+
+    remove(path.c_str());
+}
+
+/**
+    Expressions, products and transposeInPlace assigned to a mapped matrix
+    must not write into the read-only mapping
+*/
+BENCHMARK(binaryFileMappedResults)
+{
+    std::string path = temporaryPath("neuron_bench_mapped_results.bin");
+    Matrix<float> original(64, 48);
+    for (int x = 0; x < 64; x++)
+        for (int y = 0; y < 48; y++)
+            original[x][y] = (float) (x + y);
+    Matrix<float> square(48, 48);
+    square.fill(1);
+    original.save(path);
+
+    Matrix<float> scaled(path);
+    scaled = scaled * 2.f;
+    Matrix<float> transposed(path);
+    transposed.transposeInPlace();
+    Matrix<float> product(path);
+    product.dot(square, original); // 64 x 48, the size of the mapped matrix
+
+    bool correct = true;
+    for (int x = 0; x < 64; x++)
+        for (int y = 0; y < 48; y++)
+            correct = correct && scaled[x][y] == 2 * original[x][y] && transposed[y][x] == original[x][y];
+    for (int x = 0; correct && x < 64; x++)
+        correct = product[x][0] == 48 * x + 48 * 47 / 2;
+    Matrix<float> remapped(path);
+    correct = correct && remapped[63][47] == original[63][47];
+    if (!correct)
+        reportFailure("a result assigned to a mapped matrix was wrong or reached its file");
+
+    remove(path.c_str());
+}
@@ -0,0 +1,118 @@
+#include "Benchmark.h"
+
+#include "../Neuron.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+/**
+    Process start with 10k per-tenant models: every checkpoint is loaded
+    into its own neuron. The loaded weights must equal the saved ones and
+    a checkpoint with a flipped weight byte must be rejected.
+*/
+BENCHMARK(checkpointLoading)
+{
+    const int modelCount = 10000;
+    const int features = 32;
+
+    char directory[] = "/tmp/neuron_bench_modelsXXXXXX";
+    if (!mkdtemp(directory))
+    {
+        reportFailure("cannot create a temporary directory");
+        return;
+    }
+
+    std::vector<std::string> paths;
+    srand(13);
+    for (int i = 0; i < modelCount; i++)
+    {
+        Neuron neuron;
+        neuron.activationFunctionEnum = i % 2 ? TANH01 : LOGISTIC;
+        neuron.initWeightMatrix(features);
+        paths.push_back(std::string(directory) + "/model" + std::to_string(i) + ".bin");
+        if (!neuron.save(paths.back()))
+        {
+            reportFailure("saving a checkpoint failed");
+            return;
+        }
+    }
+
+    std::vector<Neuron> models(modelCount);
+    BenchmarkTimer timer;
+    int loaded = 0;
+    for (int i = 0; i < modelCount; i++)
+        loaded += models[i].load(paths[i]);
+    double seconds = timer.seconds();
+
+    reportResult("load_milliseconds", seconds * 1000, "ms");
+    reportResult("load_microseconds_per_model", seconds * 1e6 / modelCount, "us");
+    if (loaded != modelCount)
+        reportFailure("not every checkpoint could be loaded");
+
+    // The random weights are drawn in the same order again
+    srand(13);
+    for (int i = 0; i < modelCount; i++)
+    {
+        Neuron neuron;
+        neuron.initWeightMatrix(features);
+        bool equal = models[i].activationFunctionEnum == (i % 2 ? TANH01 : LOGISTIC)
+                     && models[i].weightMatrix.getSizeX() == features + 1;
+        for (int k = 0; equal && k <= features; k++)
+            equal = models[i].weightMatrix[k][0] == neuron.weightMatrix[k][0];
+        if (!equal)
+        {
+            reportFailure("a loaded checkpoint differs from the saved neuron");
+            break;
+        }
+    }
+
+    // Learning on a loaded model must not write through to its file
+    models[0].weightMatrix[1][0] += 1.0f;
+    Neuron reloaded;
+    reloaded.load(paths[0]);
+    if (reloaded.weightMatrix[1][0] == models[0].weightMatrix[1][0])
+        reportFailure("changing loaded weights modified the checkpoint file");
+
+    // A loaded model saved back to its own file, untouched and then changed
+    Neuron resaved;
+    resaved.load(paths[2]);
+    bool resavedEqual = resaved.save(paths[2]) && reloaded.load(paths[2]);
+    resaved.weightMatrix[1][0] += 1.0f;
+    resavedEqual = resavedEqual && resaved.save(paths[2]) && reloaded.load(paths[2]);
+    for (int k = 0; resavedEqual && k <= features; k++)
+        resavedEqual = reloaded.weightMatrix[k][0] == resaved.weightMatrix[k][0];
+    if (!resavedEqual)
+        reportFailure("saving a loaded checkpoint over its own file failed");
+
+    // Corrupt one weight byte
+    FILE* file = fopen(paths[1].c_str(), "r+b");
+    fseek(file, 64 + 5, SEEK_SET);
+    int byte = fgetc(file);
+    fseek(file, 64 + 5, SEEK_SET);
+    fputc(byte ^ 0x10, file);
+    fclose(file);
+    std::cout.setstate(std::ios::failbit); // Keep the expected error message out of the report
+    bool corruptLoaded = reloaded.load(paths[1]);
+    std::cout.clear();
+    if (corruptLoaded)
+        reportFailure("a corrupt checkpoint was loaded");
+
+    // The same weights claimed to be an 11 x 3 matrix, which no neuron holds
+    uint32_t shape[2] = {11, 3};
+    file = fopen(paths[3].c_str(), "r+b");
+    fseek(file, 16, SEEK_SET); // weightSizeX and weightSizeY
+    fwrite(shape, sizeof(shape), 1, file);
+    fclose(file);
+    std::cout.setstate(std::ios::failbit);
+    bool reshapedLoaded = reloaded.load(paths[3]);
+    std::cout.clear();
+    if (reshapedLoaded)
+        reportFailure("a checkpoint of more than one weight vector was loaded");
+
+    for (const std::string &path : paths)
+        unlink(path.c_str());
+    rmdir(directory);
+}
@@ -0,0 +1,155 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+#include "../ConvergenceMonitor.h"
+
+#include <vector>
+#include <stdlib.h>
+
+/**
+    The workload of main.cpp (500 samples of the x0 - x1 >= 0 problem,
+    TANH01, 50 epochs at 0.5), repeated over 200 data sets: a fixed epoch
+    count against stopping at the first epoch without errors. Both must
+    classify as well.
+*/
+BENCHMARK(convergenceEarlyStopping)
+{
+    const int runs = 200, sampleCount = 500, epoch = 50;
+    double fixedSeconds = 0, monitoredSeconds = 0;
+    long long epochsRun = 0;
+    int fixedCorrect = 0, monitoredCorrect = 0;
+    std::vector<float> output(sampleCount);
+
+    for (int run = 0; run < runs; run++)
+    {
+        Matrix<float> featureMatrix;
+        Array<float> classificationVector;
+        generateLinearData(sampleCount, 2, featureMatrix, classificationVector, 100 + run);
+
+        Neuron fixed, monitored;
+        fixed.activationFunctionEnum = monitored.activationFunctionEnum = TANH01;
+        fixed.initWeightMatrix(2);
+        monitored.initWeightMatrix(2);
+        monitored.weightMatrix = fixed.weightMatrix; // Same starting point
+
+        BenchmarkTimer timer;
+        fixed.deltaLearning(featureMatrix, classificationVector, epoch, 0.5f);
+        fixedSeconds += timer.seconds();
+
+        ConvergenceMonitor monitor;
+        timer.reset();
+        monitored.deltaLearning(featureMatrix, classificationVector, epoch, 0.5f, monitor);
+        monitoredSeconds += timer.seconds();
+        epochsRun += monitor.getEpochCount();
+
+        fixed.predictBatch(featureMatrix, output.data());
+        for (int j = 0; j < sampleCount; j++)
+            fixedCorrect += (output[j] >= 0.5f) == (classificationVector[j] >= 0.5f);
+        monitored.predictBatch(featureMatrix, output.data());
+        for (int j = 0; j < sampleCount; j++)
+            monitoredCorrect += (output[j] >= 0.5f) == (classificationVector[j] >= 0.5f);
+    }
+
+    double fixedAccuracy = (double) fixedCorrect / ((double) runs * sampleCount);
+    double monitoredAccuracy = (double) monitoredCorrect / ((double) runs * sampleCount);
+    reportResult("fixed.seconds", fixedSeconds, "s");
+    reportResult("monitored.seconds", monitoredSeconds, "s");
+    reportResult("time_saved", 1 - monitoredSeconds / fixedSeconds, "");
+    reportResult("speedup", fixedSeconds / monitoredSeconds, "x");
+    reportResult("monitored.mean_epochs", (double) epochsRun / runs, "");
+    reportResult("fixed.accuracy", fixedAccuracy, "");
+    reportResult("monitored.accuracy", monitoredAccuracy, "");
+    if (monitoredAccuracy < fixedAccuracy - 0.01)
+        reportFailure("stopping early lost accuracy");
+}
+
+/**
+    A neuron whose weights are initialised by the learning call itself, as
+    in main.cpp: the monitor must see the weight changes of the first epoch
+    and keep learning while errors remain
+*/
+BENCHMARK(convergenceFreshNeuron)
+{
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(500, 2, featureMatrix, classificationVector, 99);
+
+    srand(7);
+    Neuron monitored;
+    monitored.activationFunctionEnum = TANH01;
+    ConvergenceMonitor monitor;
+    monitored.deltaLearning(featureMatrix, classificationVector, 50, 0.5f, monitor);
+    EpochStatistics last = monitor.getLastEpoch();
+
+    reportResult("epochs", monitor.getEpochCount(), "");
+    reportResult("last_epoch.errors", last.errorCount, "samples");
+    if (last.weightDeltaNorm == 0 && last.errorCount > 0)
+        reportFailure("the monitor saw no weight change in an epoch with errors");
+    if (monitor.getEpochCount() < 50 && last.errorCount > 0)
+        reportFailure("learning stopped while errors remained");
+
+    // The epochs run learn the same weights as deltaLearning would in as many epochs
+    srand(7); // The same initial weights
+    Neuron reference;
+    reference.activationFunctionEnum = TANH01;
+    reference.deltaLearning(featureMatrix, classificationVector, monitor.getEpochCount(), 0.5f);
+    for (int k = 0; k < 3; k++)
+        if (reference.weightMatrix[k][0] != monitored.weightMatrix[k][0])
+        {
+            reportFailure("a fresh monitored neuron learnt other weights than deltaLearning");
+            break;
+        }
+}
+
+/**
+    With every tolerance disabled the monitored pass must learn exactly
+    what deltaLearning learns, call back once per epoch, and cost little
+    more per epoch on a 1M sample data set
+*/
+BENCHMARK(convergenceMonitorOverhead)
+{
+    const int sampleCount = 1000000, epoch = 5;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(sampleCount, 2, featureMatrix, classificationVector, 61);
+
+    Neuron plain, monitored;
+    plain.activationFunctionEnum = monitored.activationFunctionEnum = TANH01;
+    plain.initWeightMatrix(2);
+    monitored.initWeightMatrix(2);
+    monitored.weightMatrix = plain.weightMatrix; // Same starting point
+
+    ConvergenceMonitor monitor;
+    monitor.errorTolerance = -1;
+    monitor.weightDeltaTolerance = -1;
+    int callbacks = 0;
+    bool errorsCounted = true;
+    monitor.onEpoch = [&](const EpochStatistics &statistics)
+    {
+        callbacks++;
+        errorsCounted = errorsCounted && statistics.sampleCount == sampleCount && statistics.errorCount >= 0 && statistics.errorCount <= sampleCount;
+    };
+
+    BenchmarkTimer timer;
+    plain.deltaLearning(featureMatrix, classificationVector, epoch, 0.5f);
+    double plainSeconds = timer.seconds();
+    timer.reset();
+    monitored.deltaLearning(featureMatrix, classificationVector, epoch, 0.5f, monitor);
+    double monitoredSeconds = timer.seconds();
+
+    reportResult("plain.samples_per_second", (double) sampleCount * epoch / plainSeconds, "samples/s");
+    reportResult("monitored.samples_per_second", (double) sampleCount * epoch / monitoredSeconds, "samples/s");
+    reportResult("last_epoch.errors", monitor.getLastEpoch().errorCount, "samples");
+    reportResult("last_epoch.loss", monitor.getLastEpoch().loss, "");
+    reportResult("last_epoch.weight_delta_norm", monitor.getLastEpoch().weightDeltaNorm, "");
+
+    if (callbacks != epoch || monitor.getEpochCount() != epoch || !errorsCounted)
+        reportFailure("the monitor was not called once per epoch with sane statistics");
+    for (int k = 0; k <= 2; k++)
+        if (plain.weightMatrix[k][0] != monitored.weightMatrix[k][0])
+        {
+            reportFailure("monitored learning learnt other weights than deltaLearning");
+            break;
+        }
+}
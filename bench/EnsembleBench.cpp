@@ -0,0 +1,236 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../NeuronEnsemble.h"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <math.h>
+
+/**
+    Class c of 0 to classCount - 1 around its own random centre, the
+    features being the centre plus unit gaussian noise
+*/
+static void generateClusterData(int numberOfSamples, int dimensionality, int classCount, Matrix<float> &featureMatrix, Array<int> &classVector, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_int_distribution<int> classDistribution(0, classCount - 1);
+
+    Matrix<float> centres(classCount, dimensionality);
+    for (int c = 0; c < classCount; c++)
+        for (int k = 0; k < dimensionality; k++)
+            centres[c][k] = 4.0f * normal(generator);
+
+    featureMatrix.setSize(dimensionality, numberOfSamples);
+    classVector.setSize(numberOfSamples);
+    for (int j = 0; j < numberOfSamples; j++)
+    {
+        int c = classDistribution(generator);
+        classVector[j] = c;
+        for (int k = 0; k < dimensionality; k++)
+            featureMatrix[k][j] = centres[c][k] + normal(generator);
+    }
+}
+
+/**
+    Every model of an ensemble must learn exactly the weights of a Neuron
+    trained on its own targets, whatever the thread count and layout
+*/
+BENCHMARK(ensembleEquivalence)
+{
+    const int modelCount = 16, featureCount = 12, sampleCount = 3000, epoch = 3;
+    Matrix<float> featureMatrix;
+    Array<int> classVector;
+    generateClusterData(sampleCount, featureCount, modelCount, featureMatrix, classVector, 31);
+
+    NeuronEnsemble reference(modelCount);
+    reference.activationFunctionEnum = TANH01;
+    reference.initWeightMatrix(featureCount);
+
+    // Each model trained on its own as a Neuron
+    std::vector<Neuron> neurons(modelCount);
+    Array<float> targets(sampleCount);
+    for (int m = 0; m < modelCount; m++)
+    {
+        reference.getModel(m, neurons[m]);
+        for (int j = 0; j < sampleCount; j++)
+            targets[j] = classVector[j] == m ? 1.0f : 0.0f;
+        neurons[m].deltaLearning(featureMatrix, targets, epoch, 0.05f);
+    }
+
+    Matrix<float> sampleMajor;
+    sampleMajor = featureMatrix;
+    sampleMajor.transpose();
+    const int threadCounts[] = {1, 3, 16};
+    for (int layout = 0; layout < 2; layout++)
+        for (int threadCount : threadCounts)
+        {
+            NeuronEnsemble ensemble(modelCount);
+            ensemble.activationFunctionEnum = TANH01;
+            ensemble.initWeightMatrix(featureCount);
+            ensemble.weightMatrix = reference.weightMatrix; // Same starting point
+            ensemble.oneVsRestLearning(layout ? sampleMajor : featureMatrix, classVector, epoch, 0.05f, threadCount);
+
+            int mismatches = 0;
+            for (int m = 0; m < modelCount; m++)
+                for (int k = 0; k <= featureCount; k++)
+                    mismatches += ensemble.weightMatrix[m][k] != neurons[m].weightMatrix[k][0];
+
+            std::string name = std::string(layout ? "sample_major" : "feature_major") + ".threads_" + std::to_string(threadCount);
+            reportResult(name + ".weight_mismatches", mismatches, "");
+            if (mismatches != 0)
+                reportFailure(name + ": the ensemble did not learn the weights of the separate neurons");
+        }
+
+    // A target matrix holding the one-vs-rest targets learns the same
+    NeuronEnsemble matrixTargets(modelCount);
+    matrixTargets.activationFunctionEnum = TANH01;
+    Matrix<float> targetMatrix(modelCount, sampleCount);
+    for (int m = 0; m < modelCount; m++)
+        for (int j = 0; j < sampleCount; j++)
+            targetMatrix[m][j] = classVector[j] == m ? 1.0f : 0.0f;
+    matrixTargets.initWeightMatrix(featureCount);
+    for (int m = 0; m < modelCount; m++)
+    {
+        Neuron model;
+        reference.getModel(m, model);
+        matrixTargets.setModel(m, model);
+    }
+    matrixTargets.deltaLearning(featureMatrix, targetMatrix, epoch, 0.05f, 4);
+    for (int m = 0; m < modelCount; m++)
+        for (int k = 0; k <= featureCount; k++)
+            if (matrixTargets.weightMatrix[m][k] != neurons[m].weightMatrix[k][0])
+            {
+                reportFailure("learning from a target matrix differs from the separate neurons");
+                m = modelCount;
+                break;
+            }
+
+    // Batch responses match the neurons up to the summation order of gemm
+    Matrix<float> responses;
+    matrixTargets.predictBatch(sampleMajor, responses);
+    std::vector<float> neuronOutput(sampleCount);
+    float maxDifference = 0;
+    for (int m = 0; m < modelCount; m++)
+    {
+        neurons[m].predictBatch(featureMatrix, neuronOutput.data());
+        for (int j = 0; j < sampleCount; j++)
+            maxDifference = fmaxf(maxDifference, fabsf(responses[m][j] - neuronOutput[j]));
+    }
+    reportResult("max_response_difference", maxDifference, "");
+    if (maxDifference > 1e-4f)
+        reportFailure("ensemble batch responses differ from the neurons");
+}
+
+/**
+    One-vs-rest classification of 10 gaussian clusters. The batch
+    classification must agree with classifying sample by sample.
+*/
+BENCHMARK(ensembleOneVsRest)
+{
+    const int classCount = 10, featureCount = 16, sampleCount = 20000;
+    Matrix<float> featureMatrix;
+    Array<int> classVector;
+    generateClusterData(sampleCount, featureCount, classCount, featureMatrix, classVector, 32);
+
+    NeuronEnsemble ensemble(classCount);
+    ensemble.activationFunctionEnum = LOGISTIC;
+    ensemble.initWeightMatrix(featureCount);
+    ensemble.weightMatrix.fill(0);
+    ensemble.oneVsRestLearning(featureMatrix, classVector, 5, 0.01f, (int) std::thread::hardware_concurrency());
+
+    std::vector<int> classes(sampleCount);
+    ensemble.predictClasses(featureMatrix, classes.data());
+
+    int correct = 0, disagreements = 0;
+    for (int j = 0; j < sampleCount; j++)
+    {
+        correct += classes[j] == classVector[j];
+        disagreements += ensemble.predictClass(featureMatrix.subMatrixView(0, featureCount - 1, j, j)) != classes[j];
+    }
+
+    double accuracy = (double) correct / sampleCount;
+    reportResult("accuracy", accuracy, "");
+    reportResult("batch_disagreements", disagreements, "samples");
+    if (accuracy < 0.9)
+        reportFailure("one-vs-rest accuracy below 0.9");
+    if (disagreements > 0)
+        reportFailure("predictClasses disagrees with predictClass");
+}
+
+/**
+    Training K models over the same 64 feature data set: K separate
+    Neuron::deltaLearning calls, each streaming the whole data set, against
+    one ensemble pass on one thread and on every hardware thread
+*/
+BENCHMARK(ensembleThroughput)
+{
+    const int featureCount = 64, sampleCount = 20000;
+    Matrix<float> featureMatrix;
+    Array<int> classVector;
+    generateClusterData(sampleCount, featureCount, 256, featureMatrix, classVector, 33);
+    int hardwareThreads = (int) std::thread::hardware_concurrency();
+    if (hardwareThreads < 1)
+        hardwareThreads = 1;
+
+    const int modelCounts[] = {1, 16, 256};
+    for (int modelCount : modelCounts)
+    {
+        Array<int> classes(sampleCount);
+        for (int j = 0; j < sampleCount; j++)
+            classes[j] = classVector[j] % modelCount;
+
+        NeuronEnsemble ensemble(modelCount);
+        ensemble.activationFunctionEnum = TANH01;
+        ensemble.initWeightMatrix(featureCount);
+
+        // Separate neurons
+        std::vector<Neuron> neurons(modelCount);
+        Array<float> targets(sampleCount);
+        BenchmarkTimer timer;
+        for (int m = 0; m < modelCount; m++)
+        {
+            ensemble.getModel(m, neurons[m]);
+            for (int j = 0; j < sampleCount; j++)
+                targets[j] = classes[j] == m ? 1.0f : 0.0f;
+            neurons[m].deltaLearning(featureMatrix, targets, 1, 0.01f);
+        }
+        double separateSeconds = timer.seconds();
+
+        Matrix<float> initialWeights;
+        initialWeights = ensemble.weightMatrix; // Deep copy
+        timer.reset();
+        ensemble.oneVsRestLearning(featureMatrix, classes, 1, 0.01f, 1);
+        double ensembleSeconds = timer.seconds();
+
+        ensemble.weightMatrix = initialWeights;
+        timer.reset();
+        ensemble.oneVsRestLearning(featureMatrix, classes, 1, 0.01f, hardwareThreads);
+        double threadedSeconds = timer.seconds();
+
+        double modelUpdates = (double) sampleCount * modelCount;
+        std::string name = "models_" + std::to_string(modelCount);
+        reportResult(name + ".separate.model_updates_per_second", modelUpdates / separateSeconds, "updates/s");
+        reportResult(name + ".ensemble.model_updates_per_second", modelUpdates / ensembleSeconds, "updates/s");
+        reportResult(name + ".ensemble_threads_" + std::to_string(hardwareThreads) + ".model_updates_per_second", modelUpdates / threadedSeconds, "updates/s");
+        reportResult(name + ".speedup", separateSeconds / ensembleSeconds, "x");
+
+        for (int m = 0; m < modelCount; m++)
+            if (ensemble.weightMatrix[m][featureCount] != neurons[m].weightMatrix[featureCount][0])
+            {
+                reportFailure(name + ": the ensemble did not learn the weights of the separate neurons");
+                break;
+            }
+    }
+
+    // One-vs-rest scoring of 256 classes
+    NeuronEnsemble ensemble(256);
+    ensemble.initWeightMatrix(featureCount);
+    std::vector<int> classes(sampleCount);
+    BenchmarkTimer timer;
+    ensemble.predictClasses(featureMatrix, classes.data());
+    reportResult("models_256.classification_samples_per_second", sampleCount / timer.seconds(), "samples/s");
+}
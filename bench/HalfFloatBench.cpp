@@ -0,0 +1,232 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+#include "../HalfFloat.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+
+static bool sameFloat(float a, float b)
+{
+    return a == b || (isnan(a) && isnan(b));
+}
+
+/**
+    Every half precision value survives widening and narrowing, and the
+    vectorised conversions agree with the scalar ones on random and
+    special values, on lengths that leave tails
+*/
+BENCHMARK(halfFloatConversion)
+{
+    std::vector<Half> halves(65536), roundTrip(65536);
+    std::vector<float> widened(65536);
+    for (int i = 0; i < 65536; i++)
+        halves[i].bits = (uint16_t) i;
+    convertToFloat(halves.data(), widened.data(), 65536);
+    convertFromFloat(widened.data(), roundTrip.data(), 65536);
+    for (int i = 0; i < 65536; i++)
+    {
+        if (!sameFloat(widened[i], halfBitsToFloat((uint16_t) i)))
+            reportFailure("widening half " + std::to_string(i) + " differs from the scalar conversion");
+        if (roundTrip[i].bits != i && !isnan(widened[i]))
+        {
+            reportFailure("half " + std::to_string(i) + " does not survive a round trip");
+            break;
+        }
+    }
+
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<uint32_t> bits;
+    const int count = 100003;
+    std::vector<float> values(count);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = bitsToFloat(bits(generator));
+        if (fabsf(values[i]) < 1.2e-38f) // AVX-512 BF16 flushes subnormal floats to zero
+            values[i] = 0;
+    }
+    float specials[] = {0.0f, -0.0f, 1.0f, 65504.0f, 65520.0f, 6.1e-5f, 5.96e-8f, INFINITY, -INFINITY, NAN};
+    for (int i = 0; i < 10; i++)
+        values[i] = specials[i];
+
+    std::vector<Half> halfValues(count);
+    std::vector<BFloat16> bfloatValues(count);
+    convertFromFloat(values.data(), halfValues.data(), count);
+    convertFromFloat(values.data(), bfloatValues.data(), count);
+    for (int i = 0; i < count; i++)
+    {
+        if (halfValues[i].bits != floatToHalfBits(values[i]) && !isnan(values[i]))
+        {
+            reportFailure("narrowing " + std::to_string(values[i]) + " to half differs from the scalar conversion");
+            break;
+        }
+        if (!sameFloat(bfloatBitsToFloat(bfloatValues[i].bits), bfloatBitsToFloat(floatToBfloatBits(values[i]))))
+        {
+            reportFailure("narrowing " + std::to_string(values[i]) + " to bfloat16 differs from the scalar conversion");
+            break;
+        }
+    }
+    reportResult("kernel.half." + std::string(getHalfKernelName()), 1, "");
+    reportResult("kernel.bfloat16." + std::string(getBFloat16KernelName()), 1, "");
+}
+
+/**
+    Throughput of the vectorised conversions against element by element
+    ones, on 16M values
+*/
+BENCHMARK(halfFloatConversionThroughput)
+{
+    const long long count = 1 << 24;
+    std::vector<float> values(count), widened(count);
+    for (long long i = 0; i < count; i++)
+        values[i] = (float) (i % 1000) * 0.25f;
+    std::vector<Half> halves(count);
+    std::vector<BFloat16> bfloats(count);
+
+    BenchmarkTimer timer;
+    convertFromFloat(values.data(), halves.data(), count);
+    reportResult("half.narrow.values_per_second", count / timer.seconds(), "values/s");
+    timer.reset();
+    convertToFloat(halves.data(), widened.data(), count);
+    reportResult("half.widen.values_per_second", count / timer.seconds(), "values/s");
+    timer.reset();
+    convertFromFloat(values.data(), bfloats.data(), count);
+    reportResult("bfloat16.narrow.values_per_second", count / timer.seconds(), "values/s");
+    timer.reset();
+    convertToFloat(bfloats.data(), widened.data(), count);
+    reportResult("bfloat16.widen.values_per_second", count / timer.seconds(), "values/s");
+    timer.reset();
+    for (long long i = 0; i < count; i++)
+        halves[i] = Half(values[i]);
+    reportResult("half.scalar_narrow.values_per_second", count / timer.seconds(), "values/s");
+}
+
+/**
+    Products of 16 bit matrices accumulate in float: they equal the float
+    product of the widened operands rounded once
+*/
+BENCHMARK(halfFloatDot)
+{
+    std::mt19937 generator(24);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    Matrix<float> a(300, 200), b(100, 300);
+    for (int i = 0; i < a.getSize(); i++)
+        a.getArrayRef()[i] = normal(generator);
+    for (int i = 0; i < b.getSize(); i++)
+        b.getArrayRef()[i] = normal(generator);
+
+    Matrix<Half> halfA(a), halfB(b), halfProduct;
+    Matrix<BFloat16> bfloatA(a), bfloatB(b), bfloatProduct;
+    halfProduct.dot(halfA, halfB);
+    bfloatProduct.dot(bfloatA, bfloatB);
+
+    Matrix<float> widenedA(halfA), widenedB(halfB), expected;
+    expected.dot(widenedA, widenedB);
+    Matrix<Half> expectedHalf(expected);
+    for (int i = 0; i < expected.getSize(); i++)
+        if (halfProduct.getArrayRef()[i].bits != expectedHalf.getArrayRef()[i].bits)
+        {
+            reportFailure("the half product is not the rounded float product");
+            break;
+        }
+
+    Matrix<float> exact;
+    exact.dot(a, b);
+    float maxError = 0;
+    for (int i = 0; i < exact.getSize(); i++)
+        maxError = fmaxf(maxError, fabsf((float) bfloatProduct.getArrayRef()[i] - exact.getArrayRef()[i]));
+    reportResult("bfloat16.max_abs_error", maxError, "");
+}
+
+/**
+    Delta learning and batch prediction on a 256 feature data set held as
+    float, Half and BFloat16, in both layouts. The 16 bit paths must learn
+    exactly what float learns from the widened features, at half the memory.
+*/
+template <class T>
+static void learnWidened(const char* typeName, Matrix<float> &featureMatrix, Array<float> &classificationVector, Neuron &reference, double floatSeconds, double floatPredictionSeconds)
+{
+    const int epoch = 2;
+    Matrix<T> narrow(featureMatrix);
+    Matrix<float> widened(narrow);
+    std::string name = std::string(typeName) + (featureMatrix.getLayout() == SAMPLE_MAJOR ? ".sample_major" : ".feature_major");
+
+    Neuron onNarrow, onWidened;
+    onNarrow.activationFunctionEnum = onWidened.activationFunctionEnum = LOGISTIC;
+    onNarrow.initWeightMatrix(featureMatrix.getFeatureCount());
+    onWidened.initWeightMatrix(featureMatrix.getFeatureCount());
+    onNarrow.weightMatrix = reference.weightMatrix;
+    onWidened.weightMatrix = reference.weightMatrix;
+
+    BenchmarkTimer timer;
+    onNarrow.deltaLearning(narrow, classificationVector, epoch, 0.0001f);
+    double seconds = timer.seconds();
+    onWidened.deltaLearning(widened, classificationVector, epoch, 0.0001f);
+    for (int k = 0; k < onNarrow.weightMatrix.getSizeX(); k++)
+        if (onNarrow.weightMatrix[k][0] != onWidened.weightMatrix[k][0])
+        {
+            reportFailure(name + ": learning from 16 bit features differs from learning from the widened features");
+            break;
+        }
+
+    int sampleCount = featureMatrix.getSampleCount();
+    std::vector<float> output(sampleCount), widenedOutput(sampleCount);
+    timer.reset();
+    onNarrow.predictBatch(narrow, output.data());
+    double predictionSeconds = timer.seconds();
+    onNarrow.predictBatch(widened, widenedOutput.data());
+    for (int j = 0; j < sampleCount; j++)
+        if (output[j] != widenedOutput[j])
+        {
+            reportFailure(name + ": predicting 16 bit features differs from predicting the widened features");
+            break;
+        }
+
+    reportResult(name + ".learning_samples_per_second", (double) sampleCount * epoch / seconds, "samples/s");
+    reportResult(name + ".learning_relative_to_float", floatSeconds / seconds, "x");
+    reportResult(name + ".prediction_samples_per_second", sampleCount / predictionSeconds, "samples/s");
+    reportResult(name + ".prediction_relative_to_float", floatPredictionSeconds / predictionSeconds, "x");
+    reportResult(name + ".feature_bytes", (double) narrow.getSize() * sizeof(T), "bytes");
+}
+
+BENCHMARK(halfFloatLearning)
+{
+    const int width = 256, sampleCount = 65536, epoch = 2;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(sampleCount, width, featureMatrix, classificationVector, 25);
+    Matrix<float> sampleMajor;
+    sampleMajor = featureMatrix;
+    sampleMajor.transpose();
+
+    Matrix<float>* matrices[2] = {&featureMatrix, &sampleMajor};
+    for (Matrix<float>* matrix : matrices)
+    {
+        Neuron reference;
+        reference.activationFunctionEnum = LOGISTIC;
+        reference.initWeightMatrix(width);
+        Neuron floatNeuron;
+        floatNeuron.activationFunctionEnum = LOGISTIC;
+        floatNeuron.initWeightMatrix(width);
+        floatNeuron.weightMatrix = reference.weightMatrix;
+
+        BenchmarkTimer timer;
+        floatNeuron.deltaLearning(*matrix, classificationVector, epoch, 0.0001f);
+        double floatSeconds = timer.seconds();
+        std::vector<float> output(sampleCount);
+        timer.reset();
+        floatNeuron.predictBatch(*matrix, output.data());
+        double floatPredictionSeconds = timer.seconds();
+
+        std::string name = matrix->getLayout() == SAMPLE_MAJOR ? "float.sample_major" : "float.feature_major";
+        reportResult(name + ".learning_samples_per_second", (double) sampleCount * epoch / floatSeconds, "samples/s");
+        reportResult(name + ".prediction_samples_per_second", sampleCount / floatPredictionSeconds, "samples/s");
+        reportResult(name + ".feature_bytes", (double) matrix->getSize() * sizeof(float), "bytes");
+
+        learnWidened<Half>("half", *matrix, classificationVector, reference, floatSeconds, floatPredictionSeconds);
+        learnWidened<BFloat16>("bfloat16", *matrix, classificationVector, reference, floatSeconds, floatPredictionSeconds);
+    }
+}
@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+
+#include <string>
+#include <vector>
+#include <math.h>
+
+/**
+    Delta learning and batch prediction on the same data set stored
+    feature-major and sample-major, for 2 to 4096 features per sample.
+    Every width holds the same number of values so the timings compare
+    across widths. Both layouts must learn the same weights and predict the
+    same net inputs up to rounding.
+*/
+BENCHMARK(dataLayoutThroughput)
+{
+    const long long valueCount = 1 << 22;
+    int widths[] = {2, 8, 32, 128, 512, 4096};
+    for (int width : widths)
+    {
+        int sampleCount = (int) (valueCount / width);
+        Matrix<float> featureMajor, sampleMajor;
+        Array<float> classificationVector;
+        generateLinearData(sampleCount, width, featureMajor, classificationVector, 16);
+        sampleMajor = featureMajor;
+        sampleMajor.transpose();
+        if (sampleMajor.getLayout() != SAMPLE_MAJOR || sampleMajor.getFeatureCount() != width || sampleMajor.getSampleCount() != sampleCount)
+            reportFailure("transposing a feature matrix did not make it sample-major");
+
+        std::string name = "features_" + std::to_string(width);
+        const int epoch = 2;
+        Neuron neurons[2];
+        Matrix<float>* matrices[2] = {&featureMajor, &sampleMajor};
+        const char* layoutNames[2] = {"feature_major", "sample_major"};
+        double learningSeconds[2], predictionSeconds[2];
+        std::vector<float> outputs[2];
+        for (int l = 0; l < 2; l++)
+        {
+            neurons[l].activationFunctionEnum = LOGISTIC;
+            neurons[l].approximateActivation = false;
+            neurons[l].initWeightMatrix(width);
+        }
+        neurons[1].weightMatrix = neurons[0].weightMatrix; // Same starting point
+
+        for (int l = 0; l < 2; l++)
+        {
+            BenchmarkTimer timer;
+            neurons[l].deltaLearning(*matrices[l], classificationVector, epoch, 0.0001f);
+            learningSeconds[l] = timer.seconds();
+
+            outputs[l].resize(sampleCount);
+            neurons[l].predictBatch(*matrices[l], outputs[l].data()); // Warm up
+            timer.reset();
+            neurons[l].predictBatch(*matrices[l], outputs[l].data());
+            predictionSeconds[l] = timer.seconds();
+
+            reportResult(name + "." + layoutNames[l] + ".learning_samples_per_second", (double) sampleCount * epoch / learningSeconds[l], "samples/s");
+            reportResult(name + "." + layoutNames[l] + ".prediction_samples_per_second", sampleCount / predictionSeconds[l], "samples/s");
+        }
+        reportResult(name + ".learning_speedup", learningSeconds[0] / learningSeconds[1], "x");
+        reportResult(name + ".prediction_speedup", predictionSeconds[0] / predictionSeconds[1], "x");
+
+        // Learning does the same arithmetic in both layouts, the batch prediction sums in another order
+        for (int k = 0; k <= width; k++)
+            if (neurons[0].weightMatrix[k][0] != neurons[1].weightMatrix[k][0])
+            {
+                reportFailure(name + ": the layouts learnt different weights");
+                break;
+            }
+        // Compared on the net inputs, relative to the largest one, so the activation does not amplify the rounding
+        float maxDifference = 0, maxNetInput = 0;
+        for (int l = 0; l < 2; l++)
+        {
+            neurons[l].activationFunctionEnum = LINEAR;
+            neurons[l].predictBatch(*matrices[l], outputs[l].data());
+        }
+        for (int j = 0; j < sampleCount; j++)
+        {
+            maxDifference = fmaxf(maxDifference, fabsf(outputs[0][j] - outputs[1][j]));
+            maxNetInput = fmaxf(maxNetInput, fabsf(outputs[0][j]));
+        }
+        float relativeDifference = maxNetInput > 0 ? maxDifference / maxNetInput : maxDifference;
+        reportResult(name + ".prediction_max_relative_difference", relativeDifference, "");
+        if (relativeDifference > 1e-5f)
+            reportFailure(name + ": the layouts predicted different values");
+    }
+}
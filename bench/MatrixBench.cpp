@@ -0,0 +1,203 @@
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+
+#include <random>
+#include <string>
+
+#include "../Matrix.h"
+#include "../Gemm.h"
+#include "../Activation.h"
+
+template <class T>
+static void fillRandomly(Matrix<T> &matrix, std::mt19937 &generator)
+{
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    for (int i = 0; i < matrix.getSize(); i++)
+        matrix.getArrayRef()[i] = (T) distribution(generator);
+}
+
+/**
+    Runs dot against dotReference for an (m x k) * (k x n) product,
+    reports both speeds and fails if the results disagree
+*/
+template <class T>
+static void compareProduct(const std::string &name, int m, int n, int k, double tolerance)
+{
+    std::mt19937 generator(m * 31 + n * 7 + k);
+    Matrix<T> matrix1(k, m); // sizeX = columns, sizeY = rows
+    Matrix<T> matrix2(n, k);
+    fillRandomly(matrix1, generator);
+    fillRandomly(matrix2, generator);
+
+    Matrix<T> reference;
+    BenchmarkTimer timer;
+    reference.dotReference(matrix1, matrix2);
+    double referenceSeconds = timer.seconds();
+
+    Matrix<T> result;
+    result.dot(matrix1, matrix2); // Warm up and size the output
+    const T* storage = result.getArrayRef();
+    int repetitions = 0;
+    timer.reset();
+    do
+    {
+        result.dot(matrix1, matrix2);
+        repetitions++;
+    }
+    while (timer.seconds() < 0.2);
+    double seconds = timer.seconds() / repetitions;
+
+    double maxError = 0;
+    for (int i = 0; i < result.getSize(); i++)
+    {
+        double error = fabs((double) result.getArrayRef()[i] - (double) reference.getArrayRef()[i]);
+        if (error > maxError)
+            maxError = error;
+    }
+
+    double flops = 2.0 * m * n * k;
+    reportResult(name + ".reference_gflops", flops / referenceSeconds * 1e-9, "GFLOP/s");
+    reportResult(name + ".gflops", flops / seconds * 1e-9, "GFLOP/s");
+    reportResult(name + ".max_abs_error", maxError, "");
+    if (maxError > tolerance * k)
+        reportFailure(name + " does not match the reference product");
+    if (result.getArrayRef() != storage)
+        reportFailure(name + " reallocated an output of matching shape");
+}
+
+BENCHMARK(matrixDot)
+{
+    reportResult("kernel." + std::string(getGemmKernelName()), 1, "");
+
+    int shapes[][3] = {{1, 1, 3}, {1, 1, 1025}, {37, 29, 53}, {64, 64, 64}, {256, 256, 256}, {512, 512, 512}, {1000, 3, 3}};
+    for (auto &shape : shapes)
+    {
+        std::string name = std::to_string(shape[0]) + "x" + std::to_string(shape[1]) + "x" + std::to_string(shape[2]);
+        compareProduct<float>("float." + name, shape[0], shape[1], shape[2], 1e-6);
+        compareProduct<double>("double." + name, shape[0], shape[1], shape[2], 1e-14);
+    }
+}
+
+/**
+    Transposed operands of dot against explicitly transposed copies
+*/
+BENCHMARK(matrixDotTransposed)
+{
+    std::mt19937 generator(9);
+    int m = 67, n = 45, k = 131;
+    for (int flags = 0; flags < 4; flags++)
+    {
+        bool transpose1 = flags & 1, transpose2 = flags & 2;
+        Matrix<float> matrix1(transpose1 ? m : k, transpose1 ? k : m);
+        Matrix<float> matrix2(transpose2 ? k : n, transpose2 ? n : k);
+        fillRandomly(matrix1, generator);
+        fillRandomly(matrix2, generator);
+
+        // Explicit copies of op(matrix1) and op(matrix2)
+        Matrix<float> operand1(k, m), operand2(n, k);
+        for (int i = 0; i < m; i++)
+            for (int p = 0; p < k; p++)
+                operand1[p][i] = transpose1 ? matrix1[i][p] : matrix1[p][i];
+        for (int p = 0; p < k; p++)
+            for (int j = 0; j < n; j++)
+                operand2[j][p] = transpose2 ? matrix2[p][j] : matrix2[j][p];
+
+        Matrix<float> reference, result;
+        reference.dotReference(operand1, operand2);
+        result.dot(matrix1, matrix2, transpose1, transpose2);
+
+        double maxError = 0;
+        for (int i = 0; i < result.getSize(); i++)
+            maxError = fmax(maxError, fabs(result.getArrayRef()[i] - reference.getArrayRef()[i]));
+        reportResult("flags_" + std::to_string(flags) + ".max_abs_error", maxError, "");
+        if (result.getSizeX() != n || result.getSizeY() != m || maxError > 1e-6 * k)
+            reportFailure("transposed dot does not match the reference product");
+    }
+}
+
+/**
+    Assigning the result of an expression must take over the temporary's
+    storage instead of deep copying it, so c = a + b - a allocates no more
+    than evaluating a + b - a alone
+*/
+BENCHMARK(matrixExpressionAllocations)
+{
+    std::mt19937 generator(10);
+    Matrix<float> a(64, 64), b(64, 64), c;
+    fillRandomly(a, generator);
+    fillRandomly(b, generator);
+
+    long long before = getAllocationCount();
+    {
+        Matrix<float> discarded = a + b - a;
+    }
+    long long expressionAllocations = getAllocationCount() - before;
+
+    before = getAllocationCount();
+    c = a + b - a;
+    long long assignmentAllocations = getAllocationCount() - before;
+
+    reportResult("expression_allocations", (double) expressionAllocations, "allocations");
+    reportResult("assignment_allocations", (double) assignmentAllocations, "allocations");
+    if (assignmentAllocations > expressionAllocations)
+        reportFailure("assigning an expression result copies it");
+    for (int i = 0; i < c.getSize(); i++)
+        if (c.getArrayRef()[i] != (a.getArrayRef()[i] + b.getArrayRef()[i]) - a.getArrayRef()[i])
+        {
+            reportFailure("c = a + b - a computed wrong elements");
+            break;
+        }
+}
+
+/**
+    r = a + b - c over 10^7 elements, evaluated through temporaries the
+    way the operators used to (one full matrix per operator) against the
+    fused expression, which must not allocate into an existing r
+*/
+BENCHMARK(matrixExpressionFusion)
+{
+    const int sizeX = 1000, sizeY = 10000;
+    std::mt19937 generator(15);
+    Matrix<float> a(sizeX, sizeY), b(sizeX, sizeY), c(sizeX, sizeY), r(sizeX, sizeY);
+    fillRandomly(a, generator);
+    fillRandomly(b, generator);
+    fillRandomly(c, generator);
+
+    Matrix<float> temporary, unfused;
+    BenchmarkTimer timer;
+    temporary.add(a, b);
+    unfused.deduct(temporary, c);
+    double unfusedSeconds = timer.seconds();
+
+    r = a + b - c; // Warm up
+    long long before = getAllocationCount();
+    timer.reset();
+    r = a + b - c;
+    double fusedSeconds = timer.seconds();
+    long long allocations = getAllocationCount() - before;
+
+    double bytes = 4.0 * sizeX * sizeY * sizeof(float);
+    reportResult("temporaries.gbytes_per_second", bytes / unfusedSeconds * 1e-9, "GB/s");
+    reportResult("fused.gbytes_per_second", bytes / fusedSeconds * 1e-9, "GB/s");
+    reportResult("fused.allocations", (double) allocations, "allocations");
+    if (allocations != 0)
+        reportFailure("the fused expression allocated");
+    for (int i = 0; i < r.getSize(); i++)
+        if (r.getArrayRef()[i] != unfused.getArrayRef()[i])
+        {
+            reportFailure("the fused expression differs from the temporaries");
+            break;
+        }
+
+    // Elementwise activation fuses the same way
+    dispatchActivation(LOGISTIC, false, [&](auto activation)
+    {
+        r = applyActivation(activation, a - b);
+    });
+    for (int i = 0; i < 1000; i++)
+        if (fabs(r.getArrayRef()[i] - 1.0f / (1.0f + expf(b.getArrayRef()[i] - a.getArrayRef()[i]))) > 1e-6f)
+        {
+            reportFailure("the fused activation computed wrong elements");
+            break;
+        }
+}
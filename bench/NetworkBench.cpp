@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+
+#include <random>
+
+#include "../Network.h"
+
+/**
+    Points inside a circle of radius 0.6 are class 1, a problem a single
+    neuron cannot solve
+*/
+static void generateCircleData(int numberOfSamples, int dimensionality, Matrix<float> &featureMatrix, Matrix<float> &targetMatrix, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    featureMatrix.setSize(dimensionality, numberOfSamples);
+    targetMatrix.setSize(1, numberOfSamples);
+
+    for (int j = 0; j < numberOfSamples; j++)
+    {
+        for (int k = 0; k < dimensionality; k++)
+            featureMatrix[k][j] = distribution(generator);
+        float radius = featureMatrix[0][j] * featureMatrix[0][j] + featureMatrix[1][j] * featureMatrix[1][j];
+        targetMatrix[0][j] = radius < 0.36f ? 1.0f : 0.0f;
+    }
+}
+
+/**
+    Training and inference throughput of a 3 layer MLP (32 -> 64 -> 64 -> 1),
+    only two of the features carry information
+*/
+BENCHMARK(networkThroughput)
+{
+    const int samples = 100000;
+    const int features = 32;
+    const int batchSize = 256;
+    const int epochs = 5;
+    srand(1);
+    Matrix<float> featureMatrix, targetMatrix;
+    generateCircleData(samples, features, featureMatrix, targetMatrix, 8);
+
+    Network network(features);
+    network.addLayer(64, TANH);
+    network.addLayer(64, TANH);
+    network.addLayer(1, LOGISTIC);
+
+    BenchmarkTimer timer;
+    network.train(featureMatrix, targetMatrix, epochs, 0.5f, batchSize);
+    double trainingSeconds = timer.seconds();
+
+    Matrix<float> outputMatrix;
+    timer.reset();
+    network.predict(featureMatrix, outputMatrix);
+    double predictionSeconds = timer.seconds();
+
+    reportResult("training_samples_per_second", samples * (double) epochs / trainingSeconds, "samples/s");
+    reportResult("prediction_samples_per_second", samples / predictionSeconds, "samples/s");
+}
+
+/**
+    The same MLP has to learn the circle on the two informative features
+*/
+BENCHMARK(networkAccuracy)
+{
+    const int samples = 20000;
+    srand(1);
+    Matrix<float> featureMatrix, targetMatrix;
+    generateCircleData(samples, 2, featureMatrix, targetMatrix, 8);
+
+    Network network(2);
+    network.addLayer(64, TANH);
+    network.addLayer(64, TANH);
+    network.addLayer(1, LOGISTIC);
+    network.train(featureMatrix, targetMatrix, 10, 0.5f, 64);
+
+    Matrix<float> outputMatrix;
+    network.predict(featureMatrix, outputMatrix);
+    int correct = 0;
+    for (int j = 0; j < samples; j++)
+        if (roundf(outputMatrix[0][j]) == targetMatrix[0][j])
+            correct++;
+
+    double accuracy = correct / (double) samples;
+    reportResult("training_accuracy", accuracy, "");
+    if (accuracy < 0.9)
+        reportFailure("the network did not learn the circle");
+}
@@ -0,0 +1,120 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "AllocationCounter.h"
+
+#include "../Neuron.h"
+
+#include <string>
+#include <vector>
+#include <math.h>
+
+/**
+    Feeding a data set sample by sample (partialFit) or in small batches
+    (partialFitBatch) at a constant rate must learn exactly one epoch of
+    deltaLearning, and the update count must drive the schedule
+*/
+BENCHMARK(partialFitEquivalence)
+{
+    const int width = 8, sampleCount = 5000, batchSize = 64;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(sampleCount, width, featureMatrix, classificationVector, 51);
+    featureMatrix.transpose(); // Every sample is contiguous
+
+    Neuron epochLearning, online, batched;
+    epochLearning.activationFunctionEnum = online.activationFunctionEnum = batched.activationFunctionEnum = TANH01;
+    epochLearning.initWeightMatrix(width);
+    online.initWeightMatrix(width);
+    batched.initWeightMatrix(width);
+    online.weightMatrix = epochLearning.weightMatrix; // Same starting point
+    batched.weightMatrix = epochLearning.weightMatrix;
+    online.learningRateSchedule = batched.learningRateSchedule = LearningRateSchedule(CONSTANT_RATE, 0.001f);
+
+    epochLearning.deltaLearning(featureMatrix, classificationVector, 1, 0.001f);
+    for (int j = 0; j < sampleCount; j++)
+        online.partialFit(featureMatrix[j], width, classificationVector[j]);
+    for (int start = 0; start < sampleCount; start += batchSize)
+    {
+        int count = sampleCount - start < batchSize ? sampleCount - start : batchSize;
+        batched.partialFitBatch(featureMatrix[start], width, classificationVector.getArray() + start, count);
+    }
+
+    for (int k = 0; k <= width; k++)
+        if (online.weightMatrix[k][0] != epochLearning.weightMatrix[k][0] || batched.weightMatrix[k][0] != epochLearning.weightMatrix[k][0])
+        {
+            reportFailure("partialFit does not learn what one epoch of deltaLearning learns");
+            break;
+        }
+    if (online.updateCount != sampleCount || batched.updateCount != sampleCount)
+        reportFailure("the update count does not match the samples learnt");
+
+    // The schedules at a few update counts
+    LearningRateSchedule inverseTime(INVERSE_TIME_DECAY, 0.1f, 0.5f);
+    LearningRateSchedule inverseSqrt(INVERSE_SQRT_DECAY, 0.1f, 0.5f);
+    LearningRateSchedule exponential(EXPONENTIAL_DECAY, 0.1f, 0.5f);
+    reportResult("inverse_time.rate_at_100", inverseTime.rate(100), "");
+    reportResult("inverse_sqrt.rate_at_100", inverseSqrt.rate(100), "");
+    reportResult("exponential.rate_at_100", exponential.rate(100), "");
+    if (fabsf(inverseTime.rate(2) - 0.05f) > 1e-7f || fabsf(inverseSqrt.rate(6) - 0.05f) > 1e-7f || fabsf(exponential.rate(2) - 0.1f * expf(-1.0f)) > 1e-7f)
+        reportFailure("a learning rate schedule does not follow its formula");
+}
+
+/**
+    A simulated stream of 10M events of 8 features, cycling through 64K
+    distinct events, learnt one event at a time and in batches of 64 with
+    a decaying rate. No update may allocate.
+*/
+BENCHMARK(partialFitEventStream)
+{
+    const int width = 8, distinctEvents = 65536, batchSize = 64;
+    const long long eventCount = 10000000;
+    Matrix<float> events;
+    Array<float> targets;
+    generateLinearData(distinctEvents, width, events, targets, 52);
+    events.transpose(); // Every event is contiguous
+
+    const char* names[] = {"single", "batch_64"};
+    for (int mode = 0; mode < 2; mode++)
+    {
+        Neuron perceptron;
+        perceptron.activationFunctionEnum = TANH01;
+        perceptron.learningRateSchedule = LearningRateSchedule(INVERSE_SQRT_DECAY, 0.01f, 0.001f);
+        perceptron.partialFit(events[0], width, targets[0]); // Initialises the weights
+
+        long long before = getAllocationCount();
+        BenchmarkTimer timer;
+        for (long long i = 1; i < eventCount; )
+        {
+            int event = (int) (i % distinctEvents);
+            if (mode == 0)
+            {
+                perceptron.partialFit(events[event], width, targets[event]);
+                i++;
+            }
+            else
+            {
+                int count = distinctEvents - event < batchSize ? distinctEvents - event : batchSize;
+                perceptron.partialFitBatch(events[event], width, targets.getArray() + event, count);
+                i += count;
+            }
+        }
+        double seconds = timer.seconds();
+        long long allocations = getAllocationCount() - before;
+
+        std::vector<float> output(distinctEvents);
+        perceptron.predictBatch(events, output.data());
+        int correct = 0;
+        for (int j = 0; j < distinctEvents; j++)
+            correct += (output[j] >= 0.5f) == (targets[j] >= 0.5f);
+
+        std::string name = names[mode];
+        reportResult(name + ".events_per_second", eventCount / seconds, "events/s");
+        reportResult(name + ".allocations", (double) allocations, "allocations");
+        reportResult(name + ".accuracy", (double) correct / distinctEvents, "");
+        reportResult(name + ".final_rate", perceptron.learningRateSchedule.rate(perceptron.updateCount), "");
+        if (allocations != 0)
+            reportFailure(name + ": online learning allocates");
+        if ((double) correct / distinctEvents < 0.95)
+            reportFailure(name + ": online learning accuracy below 0.95");
+    }
+}
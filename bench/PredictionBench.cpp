@@ -0,0 +1,244 @@
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <math.h>
+
+/**
+    Scoring 1M samples: the per sample subMatrix + predict loop that
+    main.cpp used to run against a single predictBatch call.
+    Run once with a step activation and once with the TANH01 activation
+    of main.cpp, whose tanh evaluation is the remaining per sample cost.
+*/
+BENCHMARK(predictBatchScoring)
+{
+    const int samples = 1000000;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, 2, featureMatrix, classificationVector, 4);
+
+    EActivationFunction activations[] = {HEAVISIDE, TANH01};
+    const char* names[] = {"heaviside", "tanh01"};
+    for (int a = 0; a < 2; a++)
+    {
+        Neuron perceptron;
+        perceptron.activationFunctionEnum = activations[a];
+        perceptron.deltaLearning(featureMatrix, classificationVector, 1, 0.5f);
+
+        Array<float> perSampleOutput(samples);
+        BenchmarkTimer timer;
+        for (int i = 0; i < samples; i++)
+        {
+            Matrix<float> dataPoint = featureMatrix.subMatrix(0, featureMatrix.getSizeX(), i, i);
+            perSampleOutput[i] = perceptron.predict(dataPoint);
+        }
+        double perSampleSeconds = timer.seconds();
+
+        Array<float> batchOutput(samples);
+        timer.reset();
+        perceptron.predictBatch(featureMatrix, batchOutput.getArray());
+        double batchSeconds = timer.seconds();
+
+        int mismatches = 0;
+        for (int i = 0; i < samples; i++)
+            if (perSampleOutput[i] != batchOutput[i])
+                mismatches++;
+
+        std::string name = names[a];
+        reportResult(name + ".per_sample_samples_per_second", samples / perSampleSeconds, "samples/s");
+        reportResult(name + ".batch_samples_per_second", samples / batchSeconds, "samples/s");
+        reportResult(name + ".speedup", perSampleSeconds / batchSeconds, "x");
+        if (mismatches != 0)
+            reportFailure("predictBatch disagrees with predict");
+    }
+}
+
+/**
+    The per-sample scoring loop of main.cpp, which copies every sample out
+    with subMatrix, against scoring each sample through a view
+*/
+BENCHMARK(mainScoringLoop)
+{
+    const int samples = 200000;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, 2, featureMatrix, classificationVector, 14);
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.initWeightMatrix(featureMatrix.getSizeX());
+    perceptron.deltaLearning(featureMatrix, classificationVector, 1, 0.5f);
+
+    int copyingCorrect = 0;
+    long long allocationsBefore = getAllocationCount();
+    BenchmarkTimer timer;
+    for (int i = 0; i < samples; i++)
+    {
+        Matrix<float> dataPoint = featureMatrix.subMatrix(0, featureMatrix.getSizeX(), i, i);
+        if (round(perceptron.predict(dataPoint)) == classificationVector[i])
+            copyingCorrect++;
+    }
+    double copyingSeconds = timer.seconds();
+    long long copyingAllocations = getAllocationCount() - allocationsBefore;
+
+    int viewCorrect = 0;
+    allocationsBefore = getAllocationCount();
+    timer.reset();
+    for (int i = 0; i < samples; i++)
+    {
+        MatrixView<float> dataPoint = featureMatrix.subMatrixView(0, featureMatrix.getSizeX(), i, i);
+        if (round(perceptron.predict(dataPoint)) == classificationVector[i])
+            viewCorrect++;
+    }
+    double viewSeconds = timer.seconds();
+    long long viewAllocations = getAllocationCount() - allocationsBefore;
+
+    reportResult("sub_matrix.samples_per_second", samples / copyingSeconds, "samples/s");
+    reportResult("sub_matrix.allocations_per_sample", copyingAllocations / (double) samples, "allocations");
+    reportResult("view.samples_per_second", samples / viewSeconds, "samples/s");
+    reportResult("view.allocations_per_sample", viewAllocations / (double) samples, "allocations");
+    if (viewCorrect != copyingCorrect)
+        reportFailure("scoring through views classifies differently");
+    if (viewAllocations != 0)
+        reportFailure("scoring through views allocates");
+}
+
+/**
+    Latency of single predict calls on a view of one sample, as a server
+    scoring requests one by one would see it, for the 2 features of
+    main.cpp and for 256. Every call is timed on its own, so the
+    percentiles include the cost of reading the clock.
+*/
+BENCHMARK(predictLatency)
+{
+    const int samples = 100000;
+    int widths[] = {2, 256};
+    for (int width : widths)
+    {
+        Matrix<float> featureMatrix;
+        Array<float> classificationVector;
+        generateLinearData(samples, width, featureMatrix, classificationVector, 26);
+
+        Neuron perceptron;
+        perceptron.activationFunctionEnum = TANH01;
+        perceptron.initWeightMatrix(width);
+
+        std::vector<double> latencies(samples);
+        float checksum = 0;
+        for (int i = 0; i < samples; i++)
+        {
+            MatrixView<float> dataPoint = featureMatrix.subMatrixView(0, width - 1, i, i);
+            auto start = std::chrono::steady_clock::now();
+            checksum += perceptron.predict(dataPoint);
+            latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        std::string name = "features_" + std::to_string(width);
+        reportResult(name + ".p50", latencies[samples / 2], "ns");
+        reportResult(name + ".p99", latencies[(long long) samples * 99 / 100], "ns");
+        reportResult(name + ".p999", latencies[(long long) samples * 999 / 1000], "ns");
+        if (checksum != checksum)
+            reportFailure("predict returned NaN");
+    }
+}
+
+/**
+    Latency of the const predict(features, count) serving path with 1 and
+    several threads sharing one trained neuron, each scoring its own
+    requests. No call may allocate and the results must match predict on
+    a view of the same samples.
+*/
+BENCHMARK(predictConcurrentLatency)
+{
+    const int width = 32, requestsPerThread = 50000;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(requestsPerThread, width, featureMatrix, classificationVector, 27);
+    Matrix<float> requests;
+    requests = featureMatrix;
+    requests.transpose(); // Every request is contiguous
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.initWeightMatrix(width);
+    const Neuron &frozen = perceptron;
+
+    // Net inputs against predict on a view, which sums in another order, relative to the largest one
+    perceptron.activationFunctionEnum = LINEAR;
+    float maxDifference = 0, maxNetInput = 0;
+    for (int i = 0; i < requestsPerThread; i++)
+    {
+        float netInput = frozen.predict(requests[i], width);
+        maxDifference = fmaxf(maxDifference, fabsf(netInput - perceptron.predict(featureMatrix.subMatrixView(0, width - 1, i, i))));
+        maxNetInput = fmaxf(maxNetInput, fabsf(netInput));
+    }
+    if (maxDifference > 1e-5f * maxNetInput)
+        reportFailure("the serving predict path disagrees with predict on a view");
+    perceptron.activationFunctionEnum = TANH01;
+
+    std::vector<float> expected(requestsPerThread);
+    for (int i = 0; i < requestsPerThread; i++)
+        expected[i] = frozen.predict(requests[i], width);
+
+    int hardwareThreads = (int) std::thread::hardware_concurrency();
+    int threadCounts[] = {1, hardwareThreads > 4 ? hardwareThreads : 4};
+    for (int threadCount : threadCounts)
+    {
+        std::vector<double> latencies((size_t) threadCount * requestsPerThread);
+        std::vector<int> wrongResults(threadCount);
+        std::atomic<bool> go(false);
+        std::atomic<int> finished(0);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++)
+            threads.emplace_back([&, t]()
+            {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                double* threadLatencies = latencies.data() + (size_t) t * requestsPerThread;
+                int wrong = 0;
+                for (int i = 0; i < requestsPerThread; i++)
+                {
+                    int request = (i + t * 7919) % requestsPerThread;
+                    auto start = std::chrono::steady_clock::now();
+                    float output = frozen.predict(requests[request], width);
+                    threadLatencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                    wrong += output != expected[request];
+                }
+                wrongResults[t] = wrong;
+                finished.fetch_add(1, std::memory_order_release);
+            });
+
+        // Only the scoring loops run between the two counts
+        long long before = getAllocationCount();
+        go.store(true, std::memory_order_release);
+        while (finished.load(std::memory_order_acquire) != threadCount)
+            std::this_thread::yield();
+        long long allocations = getAllocationCount() - before;
+        for (std::thread &thread : threads)
+            thread.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        size_t count = latencies.size();
+        std::string name = "threads_" + std::to_string(threadCount);
+        reportResult(name + ".p50", latencies[count / 2], "ns");
+        reportResult(name + ".p99", latencies[count * 99 / 100], "ns");
+        reportResult(name + ".p999", latencies[count * 999 / 1000], "ns");
+        reportResult(name + ".allocations", (double) allocations, "allocations");
+        if (allocations != 0)
+            reportFailure(name + ": the serving predict path allocates");
+        for (int wrong : wrongResults)
+            if (wrong != 0)
+                reportFailure(name + ": concurrent predictions differ from the serial ones");
+    }
+}
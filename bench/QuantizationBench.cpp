@@ -0,0 +1,134 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../QuantizedNeuron.h"
+#include "../QuantizedDot.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+
+/**
+    Every kernel path against a plain loop, on lengths around the vector widths
+*/
+BENCHMARK(quantizedDotCorrectness)
+{
+    std::mt19937 generator(19);
+    std::uniform_int_distribution<int> distribution(-127, 127);
+    int sizes[] = {1, 31, 32, 33, 64, 100, 1000, 4097};
+    for (int size : sizes)
+    {
+        std::vector<int8_t> a(size), b(size);
+        int32_t expected = 0;
+        for (int i = 0; i < size; i++)
+        {
+            a[i] = (int8_t) distribution(generator);
+            b[i] = (int8_t) distribution(generator);
+            expected += (int32_t) a[i] * b[i];
+        }
+        if (quantizedDot(a.data(), b.data(), size) != expected)
+            reportFailure("quantized dot of " + std::to_string(size) + " values is wrong");
+    }
+    reportResult("kernel." + std::string(getQuantizedDotKernelName()), 1, "");
+}
+
+/**
+    Drift of the int8 path against the float path on the dataGenerator
+    distribution of main.cpp (TANH01, trained the same way), and on the
+    same problem widened to 64 features. Drift is measured on the
+    activations of 100000 fresh samples.
+*/
+BENCHMARK(quantizedAccuracyDrift)
+{
+    int widths[] = {2, 64};
+    for (int width : widths)
+    {
+        Matrix<float> trainingMatrix, testMatrix;
+        Array<float> trainingClasses, testClasses;
+        generateLinearData(500, width, trainingMatrix, trainingClasses, 20);
+        generateLinearData(100000, width, testMatrix, testClasses, 21);
+
+        Neuron neuron;
+        neuron.activationFunctionEnum = TANH01;
+        neuron.deltaLearning(trainingMatrix, trainingClasses, 50, 0.5f);
+        QuantizedNeuron quantized(neuron);
+
+        int sampleCount = testClasses.size();
+        std::vector<float> floatOutput(sampleCount), quantizedOutput(sampleCount);
+        neuron.predictBatch(testMatrix, floatOutput.data());
+        quantized.predictBatch(testMatrix, quantizedOutput.data());
+
+        double maxDrift = 0, driftSum = 0;
+        int floatCorrect = 0, quantizedCorrect = 0, disagreements = 0;
+        for (int j = 0; j < sampleCount; j++)
+        {
+            double drift = fabs(floatOutput[j] - quantizedOutput[j]);
+            maxDrift = drift > maxDrift ? drift : maxDrift;
+            driftSum += drift;
+            floatCorrect += roundf(floatOutput[j]) == testClasses[j];
+            quantizedCorrect += roundf(quantizedOutput[j]) == testClasses[j];
+            disagreements += roundf(floatOutput[j]) != roundf(quantizedOutput[j]);
+        }
+
+        std::string name = "features_" + std::to_string(width);
+        reportResult(name + ".float_accuracy", (double) floatCorrect / sampleCount, "");
+        reportResult(name + ".int8_accuracy", (double) quantizedCorrect / sampleCount, "");
+        reportResult(name + ".disagreement_rate", (double) disagreements / sampleCount, "");
+        reportResult(name + ".mean_abs_drift", driftSum / sampleCount, "");
+        reportResult(name + ".max_abs_drift", maxDrift, "");
+        if (quantizedCorrect < floatCorrect - sampleCount / 100)
+            reportFailure(name + ": int8 accuracy dropped by more than 1%");
+
+        // A single data point takes the same path on its own scale
+        float single = quantized.predict(testMatrix.subMatrixView(0, width - 1, 0, 0));
+        if (fabsf(single - floatOutput[0]) > 0.05f)
+            reportFailure(name + ": quantized predict drifted from the float path");
+    }
+}
+
+/**
+    Batch scoring of 256 feature samples: the float paths on both layouts
+    against the int8 path on features quantized once, as they would be
+    stored for serving
+*/
+BENCHMARK(quantizedThroughput)
+{
+    const int width = 256, sampleCount = 100000, repetitions = 5;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(sampleCount, width, featureMatrix, classificationVector, 22);
+    Matrix<float> sampleMajor;
+    sampleMajor = featureMatrix;
+    sampleMajor.transpose();
+
+    Neuron neuron;
+    neuron.activationFunctionEnum = LOGISTIC;
+    neuron.deltaLearning(featureMatrix, classificationVector, 1, 0.001f);
+    QuantizedNeuron quantized(neuron);
+    QuantizedFeatureMatrix quantizedFeatures(featureMatrix);
+
+    std::vector<float> output(sampleCount);
+    double seconds[3];
+    for (int path = 0; path < 3; path++)
+    {
+        BenchmarkTimer timer;
+        for (int r = 0; r < repetitions; r++)
+        {
+            if (path == 0)
+                neuron.predictBatch(featureMatrix, output.data());
+            else if (path == 1)
+                neuron.predictBatch(sampleMajor, output.data());
+            else
+                quantized.predictBatch(quantizedFeatures, output.data());
+        }
+        seconds[path] = timer.seconds() / repetitions;
+    }
+
+    reportResult("float.feature_major.samples_per_second", sampleCount / seconds[0], "samples/s");
+    reportResult("float.sample_major.samples_per_second", sampleCount / seconds[1], "samples/s");
+    reportResult("int8.samples_per_second", sampleCount / seconds[2], "samples/s");
+    reportResult("int8.speedup", seconds[1] / seconds[2], "x");
+    reportResult("float.bytes_per_sample", width * sizeof(float), "bytes");
+    reportResult("int8.bytes_per_sample", width * sizeof(int8_t), "bytes");
+}
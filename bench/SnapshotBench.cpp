@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../NeuronSnapshot.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static float weightSum(const NeuronSnapshot* snapshot)
+{
+    float sum = 0;
+    for (int k = 0; k < snapshot->weights.size(); k++)
+        sum += snapshot->weights[k];
+    return sum;
+}
+
+/**
+    Train while serving: a trainer publishes its weights every 500
+    samples while reader threads score requests against pinned snapshots.
+    A pinned snapshot must never change (a reclaimed snapshot reused too
+    early would change version and weights under the reader) and the
+    versions a reader sees must never go back. The scoring rate while
+    training is compared to the rate against a model that is not trained.
+*/
+BENCHMARK(snapshotTrainWhileServe)
+{
+    const int width = 32, sampleCount = 20000, epoch = 30, publishInterval = 500, requestsPerPin = 8;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(sampleCount, width, featureMatrix, classificationVector, 41);
+    Matrix<float> requests;
+    requests = featureMatrix;
+    requests.transpose(); // Every request is contiguous
+
+    Neuron trained, reference;
+    trained.activationFunctionEnum = reference.activationFunctionEnum = TANH01;
+    trained.initWeightMatrix(width);
+    reference.initWeightMatrix(width);
+    reference.weightMatrix = trained.weightMatrix; // Same starting point
+
+    NeuronPublisher publisher;
+    publisher.publish(trained);
+
+    int hardwareThreads = (int) std::thread::hardware_concurrency();
+    int readerCount = hardwareThreads > 4 ? hardwareThreads - 1 : 3;
+    std::atomic<bool> stop(false);
+    std::atomic<long long> violations(0);
+    std::vector<long long> predictions(readerCount);
+
+    auto serve = [&](int reader)
+    {
+        NeuronReader neuronReader(publisher);
+        long long lastVersion = 0, count = 0;
+        float checksum = 0;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            const NeuronSnapshot* snapshot = neuronReader.pin();
+            long long version = snapshot->version;
+            float sum = weightSum(snapshot);
+            for (int i = 0; i < requestsPerPin; i++)
+                checksum += snapshot->predict(requests[(count + i) % sampleCount], width);
+            if (snapshot->version != version || weightSum(snapshot) != sum || version < lastVersion)
+                violations.fetch_add(1, std::memory_order_relaxed);
+            neuronReader.unpin();
+            lastVersion = version;
+            count += requestsPerPin;
+        }
+        predictions[reader] = checksum == checksum ? count : 0;
+    };
+
+    auto runReaders = [&](auto &&whileServing)
+    {
+        stop.store(false);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < readerCount; r++)
+            readers.emplace_back(serve, r);
+        BenchmarkTimer timer;
+        whileServing();
+        stop.store(true);
+        for (std::thread &reader : readers)
+            reader.join();
+        double seconds = timer.seconds();
+        long long total = 0;
+        for (long long count : predictions)
+            total += count;
+        return total / seconds;
+    };
+
+    // Serving a model that is not trained
+    double idleRate = runReaders([]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    });
+
+    // Serving while training
+    double trainingSeconds = 0;
+    double trainingRate = runReaders([&]()
+    {
+        BenchmarkTimer timer;
+        trained.deltaLearning(featureMatrix, classificationVector, epoch, 0.001f, publisher, publishInterval);
+        trainingSeconds = timer.seconds();
+    });
+
+    BenchmarkTimer timer;
+    reference.deltaLearning(featureMatrix, classificationVector, epoch, 0.001f);
+    double referenceSeconds = timer.seconds();
+
+    reportResult("readers", readerCount, "");
+    reportResult("publishes", (double) publisher.getVersion(), "");
+    reportResult("idle.predictions_per_second", idleRate, "predictions/s");
+    reportResult("training.predictions_per_second", trainingRate, "predictions/s");
+    reportResult("training.samples_per_second", (double) sampleCount * epoch / trainingSeconds, "samples/s");
+    reportResult("reference.samples_per_second", (double) sampleCount * epoch / referenceSeconds, "samples/s");
+    reportResult("snapshot_violations", (double) violations.load(), "");
+    if (violations.load() != 0)
+        reportFailure("a reader saw its pinned snapshot change or an older version");
+
+    // Publishing does not change what is learnt, and the last publish holds the final weights
+    NeuronReader finalReader(publisher);
+    const NeuronSnapshot* snapshot = finalReader.pin();
+    for (int k = 0; k <= width; k++)
+        if (trained.weightMatrix[k][0] != reference.weightMatrix[k][0] || snapshot->weights[k] != trained.weightMatrix[k][0])
+        {
+            reportFailure("the published weights differ from delta learning without publishing");
+            break;
+        }
+    finalReader.unpin();
+
+    // With no reader pinned, the next publish reclaims everything retired
+    publisher.publish(trained);
+    reportResult("retired_after_readers", publisher.getRetiredCount(), "");
+    if (publisher.getRetiredCount() != 0)
+        reportFailure("retired snapshots are not reclaimed once the readers are gone");
+}
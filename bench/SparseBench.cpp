@@ -0,0 +1,140 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+
+#include "../Neuron.h"
+#include "../SparseMatrix.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+/**
+    Dense and sparse delta learning and batch prediction on the same
+    4096 feature data set with 1% of the features set. Both must learn the
+    same weights up to the order the net inputs are summed in.
+*/
+BENCHMARK(sparseLearning)
+{
+    const int sampleCount = 20000, featureCount = 4096, epoch = 2;
+    Matrix<float> denseMatrix;
+    Array<float> classificationVector;
+    generateSparseData(sampleCount, featureCount, 0.01f, denseMatrix, classificationVector, 17);
+    SparseMatrix<float> sparseMatrix(denseMatrix);
+    if (sparseMatrix.getSampleCount() != sampleCount || sparseMatrix.getFeatureCount() != featureCount)
+        reportFailure("the sparse matrix does not have the shape of the dense one");
+
+    Neuron dense, sparse;
+    dense.activationFunctionEnum = sparse.activationFunctionEnum = LOGISTIC;
+    dense.initWeightMatrix(featureCount);
+    sparse.initWeightMatrix(featureCount);
+    dense.weightMatrix.fill(0);
+    sparse.weightMatrix = dense.weightMatrix; // Same starting point
+
+    BenchmarkTimer timer;
+    dense.deltaLearning(denseMatrix, classificationVector, epoch, 0.1f);
+    double denseSeconds = timer.seconds();
+    timer.reset();
+    sparse.deltaLearning(sparseMatrix, classificationVector, epoch, 0.1f);
+    double sparseSeconds = timer.seconds();
+
+    float maxDifference = 0;
+    for (int k = 0; k <= featureCount; k++)
+        maxDifference = fmaxf(maxDifference, fabsf(dense.weightMatrix[k][0] - sparse.weightMatrix[k][0]));
+
+    std::vector<float> denseOutput(sampleCount), sparseOutput(sampleCount);
+    timer.reset();
+    dense.predictBatch(denseMatrix, denseOutput.data());
+    double densePredictionSeconds = timer.seconds();
+    timer.reset();
+    sparse.predictBatch(sparseMatrix, sparseOutput.data());
+    double sparsePredictionSeconds = timer.seconds();
+
+    int correct = 0;
+    for (int j = 0; j < sampleCount; j++)
+        correct += (sparseOutput[j] >= 0.5f) == (classificationVector[j] >= 0.5f);
+
+    reportResult("non_zeros", sparseMatrix.getNonZeroCount(), "");
+    reportResult("dense.learning_samples_per_second", (double) sampleCount * epoch / denseSeconds, "samples/s");
+    reportResult("sparse.learning_samples_per_second", (double) sampleCount * epoch / sparseSeconds, "samples/s");
+    reportResult("learning_speedup", denseSeconds / sparseSeconds, "x");
+    reportResult("dense.prediction_samples_per_second", sampleCount / densePredictionSeconds, "samples/s");
+    reportResult("sparse.prediction_samples_per_second", sampleCount / sparsePredictionSeconds, "samples/s");
+    reportResult("prediction_speedup", densePredictionSeconds / sparsePredictionSeconds, "x");
+    reportResult("max_weight_difference", maxDifference, "");
+    reportResult("sparse.accuracy", (double) correct / sampleCount, "");
+    if (maxDifference > 1e-3f)
+        reportFailure("sparse and dense delta learning learnt different weights");
+
+    // The sparse matrix converts back to the dense one
+    Matrix<float> roundTrip = sparseMatrix.toDense();
+    for (int i = 0; i < roundTrip.getSize(); i++)
+        if (roundTrip.getArrayRef()[i] != denseMatrix.getArrayRef()[i])
+        {
+            reportFailure("toDense does not restore the dense matrix");
+            break;
+        }
+}
+
+/**
+    One million hashed binary features, 16 set per sample and labelled by a
+    hidden linear model. The dense feature matrix would need 400 GB.
+*/
+BENCHMARK(sparseHashedFeatures)
+{
+    const int featureCount = 1 << 20, sampleCount = 100000, setFeatures = 16, epoch = 5;
+    std::mt19937 generator(18);
+    std::uniform_int_distribution<int> hash(0, featureCount - 1);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    std::vector<float> hiddenWeights(featureCount);
+    for (float &weight : hiddenWeights)
+        weight = normal(generator);
+
+    SparseMatrix<float> featureMatrix(featureCount);
+    featureMatrix.reserve(sampleCount, sampleCount * setFeatures);
+    Array<float> classificationVector(sampleCount);
+    int indices[setFeatures];
+    float values[setFeatures];
+    std::fill(values, values + setFeatures, 1.0f);
+    for (int j = 0; j < sampleCount; j++)
+    {
+        float sum = 0;
+        for (int n = 0; n < setFeatures; n++)
+        {
+            indices[n] = hash(generator);
+            sum += hiddenWeights[indices[n]];
+        }
+        std::sort(indices, indices + setFeatures);
+        featureMatrix.addSample(indices, values, setFeatures);
+        classificationVector[j] = sum >= 0 ? 1.0f : 0.0f;
+    }
+
+    Neuron neuron;
+    neuron.activationFunctionEnum = LOGISTIC;
+    neuron.initWeightMatrix(featureCount);
+    neuron.weightMatrix.fill(0);
+
+    BenchmarkTimer timer;
+    neuron.deltaLearning(featureMatrix, classificationVector, epoch, 0.5f);
+    double learningSeconds = timer.seconds();
+
+    std::vector<float> output(sampleCount);
+    timer.reset();
+    neuron.predictBatch(featureMatrix, output.data());
+    double predictionSeconds = timer.seconds();
+
+    int correct = 0;
+    for (int j = 0; j < sampleCount; j++)
+        correct += (output[j] >= 0.5f) == (classificationVector[j] >= 0.5f);
+
+    double sparseBytes = (double) featureMatrix.getNonZeroCount() * (sizeof(int) + sizeof(float)) + (sampleCount + 1.0) * sizeof(int);
+    reportResult("learning_samples_per_second", (double) sampleCount * epoch / learningSeconds, "samples/s");
+    reportResult("prediction_samples_per_second", sampleCount / predictionSeconds, "samples/s");
+    reportResult("training_accuracy", (double) correct / sampleCount, "");
+    reportResult("sparse_bytes", sparseBytes, "bytes");
+    reportResult("dense_bytes", (double) featureCount * sampleCount * sizeof(float), "bytes");
+    if (correct < sampleCount * 0.9)
+        reportFailure("sparse learning did not fit the hashed features");
+}
@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+
+#include "../Matrix.h"
+#include "../Array.h"
+#include "../ThreadPool.h"
+
+#include <stdint.h>
+#include <memory>
+
+/**
+    Small model training keeps creating and resizing small matrices.
+    Matrix churn through the pool against the same churn through new T[],
+    single threaded and on a thread pool, plus the alignment and the
+    statistics of the pool.
+*/
+BENCHMARK(storagePool)
+{
+    const int iterations = 1000000;
+    const int threadCount = 4;
+
+    /// Alignment of every size class and of sizes beyond them
+    int sizes[] = {0, 1, 3, 17, 100, 1000, 4096, 100000, 1000000};
+    for (int size : sizes)
+    {
+        Matrix<float> matrix(size, 1);
+        Array<double> array(size);
+        if ((uintptr_t) matrix.getArrayRef() % 64 != 0 || (uintptr_t) array.getArray() % 64 != 0)
+            reportFailure("storage of " + std::to_string(size) + " elements is not 64 byte aligned");
+    }
+
+    /// Statistics
+    resetStorageStatistics();
+    StorageStatistics before = getStorageStatistics();
+    {
+        Matrix<float> a(16, 16), b(16, 16), c(16, 16);
+        StorageStatistics during = getStorageStatistics();
+        if (during.allocations - before.allocations != 6 || during.bytes - before.bytes < 3 * 16 * 16 * 4)
+            reportFailure("the statistics miss the buffers or control blocks of 3 matrices");
+    }
+    StorageStatistics after = getStorageStatistics();
+    reportResult("statistics.allocations", (double) after.allocations, "allocations");
+    reportResult("statistics.pool_hits", (double) after.poolHits, "allocations");
+    reportResult("statistics.peak_bytes", (double) after.peakBytes, "bytes");
+    if (after.bytes != before.bytes || after.peakBytes <= before.bytes)
+        reportFailure("the statistics do not track bytes and peak");
+
+    /// Churn through the pool
+    auto poolChurn = [&](int thread)
+    {
+        for (int i = thread; i < iterations; i += threadCount)
+        {
+            Matrix<float> matrix(8 + i % 24, 8);
+            matrix[0][0] = (float) i;
+        }
+    };
+
+    // Churn through the global heap, the way the buffers were allocated before
+    auto heapChurn = [&](int thread)
+    {
+        for (int i = thread; i < iterations; i += threadCount)
+        {
+            std::shared_ptr<float[]> buffer(new float[(8 + i % 24) * 8]);
+            buffer[0] = (float) i;
+        }
+    };
+
+    long long globalBefore = getAllocationCount() - getStorageStatistics().allocations;
+    BenchmarkTimer timer;
+    for (int i = 0; i < threadCount; i++)
+        poolChurn(i);
+    double poolSeconds = timer.seconds();
+    long long globalAllocations = getAllocationCount() - getStorageStatistics().allocations - globalBefore;
+
+    timer.reset();
+    for (int i = 0; i < threadCount; i++)
+        heapChurn(i);
+    double heapSeconds = timer.seconds();
+
+    ThreadPool threadPool(threadCount);
+    timer.reset();
+    threadPool.run(poolChurn);
+    double threadedPoolSeconds = timer.seconds();
+    timer.reset();
+    threadPool.run(heapChurn);
+    double threadedHeapSeconds = timer.seconds();
+
+    reportResult("pool.matrices_per_second", iterations / poolSeconds, "matrices/s");
+    reportResult("heap.matrices_per_second", iterations / heapSeconds, "matrices/s");
+    reportResult("threads_" + std::to_string(threadCount) + ".pool.matrices_per_second", iterations / threadedPoolSeconds, "matrices/s");
+    reportResult("threads_" + std::to_string(threadCount) + ".heap.matrices_per_second", iterations / threadedHeapSeconds, "matrices/s");
+    if (globalAllocations != 0)
+        reportFailure("matrix churn reached the global heap");
+}
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "AllocationCounter.h"
+
+#include "../Neuron.h"
+#include "../SampleReader.h"
+
+#include <stdio.h>
+#include <string>
+
+/**
+    Streaming learning through both readers against delta learning on the
+    whole matrix in memory. The samples are visited in the same order, so
+    the weights must come out identical. The chunk buffers are the only
+    per-run allocations that grow with the data, two chunks in total.
+*/
+BENCHMARK(streamingLearning)
+{
+    const int samples = 500000;
+    const int features = 16;
+    const int chunkSize = 8192;
+    const int epochs = 3;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, features, featureMatrix, classificationVector, 12);
+
+    std::string featurePath = std::string(P_tmpdir) + "/neuron_bench_stream_features.bin";
+    std::string classificationPath = std::string(P_tmpdir) + "/neuron_bench_stream_labels.bin";
+    featureMatrix.save(featurePath);
+    classificationVector.save(classificationPath);
+
+    Neuron inMemory;
+    inMemory.activationFunctionEnum = TANH01;
+    inMemory.initWeightMatrix(features);
+    Matrix<float> initialWeights;
+    initialWeights = inMemory.weightMatrix;
+
+    BenchmarkTimer timer;
+    inMemory.deltaLearning(featureMatrix, classificationVector, epochs, 0.01f);
+    reportResult("in_memory_samples_per_second", samples * (double) epochs / timer.seconds(), "samples/s");
+
+    BinaryFileSampleReader fileReader(featurePath, classificationPath);
+    MappedSampleReader mappedReader(featurePath, classificationPath);
+    SampleReader* readers[2] = {&fileReader, &mappedReader};
+    const char* names[2] = {"file", "mapped"};
+
+    for (int r = 0; r < 2; r++)
+    {
+        Neuron streamed;
+        streamed.activationFunctionEnum = TANH01;
+        streamed.initWeightMatrix(features);
+        streamed.weightMatrix = initialWeights;
+
+        long long allocationsBefore = getAllocationCount();
+        timer.reset();
+        streamed.streamingLearning(*readers[r], epochs, 0.01f, chunkSize);
+        double seconds = timer.seconds();
+        long long allocations = getAllocationCount() - allocationsBefore;
+
+        reportResult(std::string(names[r]) + ".samples_per_second", samples * (double) epochs / seconds, "samples/s");
+        reportResult(std::string(names[r]) + ".allocations", (double) allocations, "allocations");
+        for (int k = 0; k <= features; k++)
+            if (streamed.weightMatrix[k][0] != inMemory.weightMatrix[k][0])
+            {
+                reportFailure(std::string(names[r]) + " streaming learning differs from delta learning");
+                break;
+            }
+    }
+
+    reportResult("chunk_buffer_bytes", 2.0 * chunkSize * (features + 1) * sizeof(float), "bytes");
+    remove(featurePath.c_str());
+    remove(classificationPath.c_str());
+}
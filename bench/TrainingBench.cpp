@@ -0,0 +1,225 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "AllocationCounter.h"
+
+#include "../Neuron.h"
+
+#include <string>
+#include <thread>
+
+/**
+    Delta learning must not allocate once the epoch loop is running.
+    The allocations of a 1 epoch run and an 11 epoch run are compared,
+    any difference comes from the steady state inner loop.
+*/
+BENCHMARK(deltaLearningAllocations)
+{
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(10000, 2, featureMatrix, classificationVector, 1);
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.initWeightMatrix(featureMatrix.getSizeX());
+
+    long long before = getAllocationCount();
+    perceptron.deltaLearning(featureMatrix, classificationVector, 1, 0.5f);
+    long long singleEpoch = getAllocationCount() - before;
+
+    before = getAllocationCount();
+    perceptron.deltaLearning(featureMatrix, classificationVector, 11, 0.5f);
+    long long elevenEpochs = getAllocationCount() - before;
+
+    long long steadyState = elevenEpochs - singleEpoch;
+    reportResult("setup_allocations", (double) singleEpoch, "allocations");
+    reportResult("steady_state_allocations", (double) steadyState, "allocations");
+    if (steadyState != 0)
+        reportFailure("delta learning allocates inside the epoch loop");
+}
+
+BENCHMARK(hebbianLearningAllocations)
+{
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(10000, 2, featureMatrix, classificationVector, 2);
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.initWeightMatrix(featureMatrix.getSizeX());
+
+    long long before = getAllocationCount();
+    perceptron.hebbianLearning(featureMatrix, 1, 0.001f);
+    long long singleEpoch = getAllocationCount() - before;
+
+    before = getAllocationCount();
+    perceptron.hebbianLearning(featureMatrix, 11, 0.001f);
+    long long steadyState = getAllocationCount() - before - singleEpoch;
+
+    reportResult("steady_state_allocations", (double) steadyState, "allocations");
+    if (steadyState != 0)
+        reportFailure("hebbian learning allocates inside the epoch loop");
+}
+
+/**
+    Online delta learning throughput on the 2 feature problem of main.cpp
+*/
+BENCHMARK(deltaLearningThroughput)
+{
+    const int samples = 1000000;
+    const int epochs = 5;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, 2, featureMatrix, classificationVector, 3);
+
+    Neuron perceptron;
+    perceptron.activationFunctionEnum = TANH01;
+    perceptron.initWeightMatrix(featureMatrix.getSizeX());
+
+    BenchmarkTimer timer;
+    perceptron.deltaLearning(featureMatrix, classificationVector, epochs, 0.5f);
+    double seconds = timer.seconds();
+
+    reportResult("samples_per_second", samples * (double) epochs / seconds, "samples/s");
+    reportResult("samples_per_second_per_core", samples * (double) epochs / seconds, "samples/s"); // Single threaded
+}
+
+/**
+    Mini-batch learning scaling from 1 thread up to the hardware thread
+    count, plus a check that two runs with the same thread count produce
+    bit-identical weights and that batch size 1 reproduces deltaLearning
+*/
+BENCHMARK(miniBatchLearningScaling)
+{
+    const int samples = 1000000;
+    const int features = 32;
+    const int epochs = 2;
+    const int batchSize = 512;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateLinearData(samples, features, featureMatrix, classificationVector, 5);
+
+    int maxThreads = (int) std::thread::hardware_concurrency();
+    if (maxThreads < 4)
+        maxThreads = 4;
+
+    double singleThreadSeconds = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Neuron perceptron;
+        perceptron.activationFunctionEnum = TANH01;
+        perceptron.initWeightMatrix(features);
+        perceptron.weightMatrix.fill(0);
+        Neuron repeat = perceptron;
+        repeat.weightMatrix = perceptron.weightMatrix; // Deep copy
+
+        BenchmarkTimer timer;
+        perceptron.miniBatchLearning(featureMatrix, classificationVector, epochs, 0.01f, batchSize, threads);
+        double seconds = timer.seconds();
+        if (threads == 1)
+            singleThreadSeconds = seconds;
+
+        repeat.miniBatchLearning(featureMatrix, classificationVector, epochs, 0.01f, batchSize, threads);
+        for (int k = 0; k < perceptron.weightMatrix.getSize(); k++)
+            if (perceptron.weightMatrix.getArrayRef()[k] != repeat.weightMatrix.getArrayRef()[k])
+            {
+                reportFailure("mini-batch learning is not reproducible with " + std::to_string(threads) + " threads");
+                break;
+            }
+
+        std::string name = "threads_" + std::to_string(threads);
+        reportResult(name + ".samples_per_second", samples * (double) epochs / seconds, "samples/s");
+        reportResult(name + ".samples_per_second_per_core", samples * (double) epochs / seconds / threads, "samples/s");
+        reportResult(name + ".speedup", singleThreadSeconds / seconds, "x");
+    }
+
+    Neuron online, batched;
+    online.activationFunctionEnum = batched.activationFunctionEnum = TANH01;
+    online.initWeightMatrix(features);
+    batched.initWeightMatrix(features);
+    batched.weightMatrix = online.weightMatrix;
+    online.deltaLearning(featureMatrix, classificationVector, 1, 0.01f);
+    batched.miniBatchLearning(featureMatrix, classificationVector, 1, 0.01f, 1, 1);
+    for (int k = 0; k < online.weightMatrix.getSize(); k++)
+        if (online.weightMatrix.getArrayRef()[k] != batched.weightMatrix.getArrayRef()[k])
+        {
+            reportFailure("batch size 1 does not reproduce delta learning");
+            break;
+        }
+}
+
+static float trainingAccuracy(Neuron &perceptron, Matrix<float> &featureMatrix, Array<float> &classificationVector)
+{
+    Array<float> predictions(classificationVector.size());
+    perceptron.predictBatch(featureMatrix, predictions.getArray());
+    int correct = 0;
+    for (int i = 0; i < classificationVector.size(); i++)
+        if (roundf(predictions[i]) == classificationVector[i])
+            correct++;
+    return correct / (float) classificationVector.size();
+}
+
+/**
+    Hogwild style asynchronous learning against serial delta learning on
+    sparse click-like features: throughput and accuracy after the same
+    number of epochs
+*/
+BENCHMARK(asynchronousLearningSparse)
+{
+    const int samples = 100000;
+    const int features = 1000;
+    const int epochs = 3;
+    Matrix<float> featureMatrix;
+    Array<float> classificationVector;
+    generateSparseData(samples, features, 0.01f, featureMatrix, classificationVector, 6);
+
+    Neuron serial;
+    serial.activationFunctionEnum = LOGISTIC;
+    serial.initWeightMatrix(features);
+    serial.weightMatrix.fill(0);
+    BenchmarkTimer timer;
+    serial.deltaLearning(featureMatrix, classificationVector, epochs, 0.1f);
+    double serialSeconds = timer.seconds();
+    reportResult("serial.samples_per_second", samples * (double) epochs / serialSeconds, "samples/s");
+    float serialAccuracy = trainingAccuracy(serial, featureMatrix, classificationVector);
+    reportResult("serial.accuracy", serialAccuracy, "");
+
+    // The same non-zeros as lists of indices and values
+    SparseMatrix<float> sparseFeatureMatrix(featureMatrix);
+    Neuron sparseSerial;
+    sparseSerial.activationFunctionEnum = LOGISTIC;
+    sparseSerial.initWeightMatrix(features);
+    sparseSerial.weightMatrix.fill(0);
+    timer.reset();
+    sparseSerial.deltaLearning(sparseFeatureMatrix, classificationVector, epochs, 0.1f);
+    double sparseSerialSeconds = timer.seconds();
+    reportResult("sparse_serial.samples_per_second", samples * (double) epochs / sparseSerialSeconds, "samples/s");
+
+    int maxThreads = (int) std::thread::hardware_concurrency();
+    if (maxThreads < 4)
+        maxThreads = 4;
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+        for (int sparse = 0; sparse < 2; sparse++)
+        {
+            Neuron hogwild;
+            hogwild.activationFunctionEnum = LOGISTIC;
+            hogwild.initWeightMatrix(features);
+            hogwild.weightMatrix.fill(0);
+            timer.reset();
+            if (sparse)
+                hogwild.asynchronousLearning(sparseFeatureMatrix, classificationVector, epochs, 0.1f, threads);
+            else
+                hogwild.asynchronousLearning(featureMatrix, classificationVector, epochs, 0.1f, threads);
+            double seconds = timer.seconds();
+
+            std::string name = std::string(sparse ? "sparse_async_threads_" : "async_threads_") + std::to_string(threads);
+            reportResult(name + ".samples_per_second", samples * (double) epochs / seconds, "samples/s");
+            reportResult(name + ".speedup", serialSeconds / seconds, "x");
+            if (sparse)
+                reportResult(name + ".speedup_over_sparse_serial", sparseSerialSeconds / seconds, "x");
+            float accuracy = trainingAccuracy(hogwild, featureMatrix, classificationVector);
+            reportResult(name + ".accuracy", accuracy, "");
+            if (threads == 1 && accuracy < serialAccuracy - 0.01f)
+                reportFailure(name + ": asynchronous learning on one thread is less accurate than serial learning");
+        }
+}
@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+
+#include "../Matrix.h"
+#include "../Transpose.h"
+
+#include <random>
+#include <string>
+#include <algorithm>
+
+template <class T>
+static bool checkTransposed(int sizeX, int sizeY, const T* source, const T* transposed)
+{
+    for (int x = 0; x < sizeX; x++)
+        for (int y = 0; y < sizeY; y++)
+            if (transposed[(long long) y * sizeX + x] != source[(long long) x * sizeY + y])
+                return false;
+    return true;
+}
+
+template <class T>
+static void checkShapes(const char* typeName)
+{
+    std::mt19937 generator(16);
+    int shapes[][2] = {{1, 1}, {1, 9}, {8, 8}, {7, 13}, {33, 65}, {100, 37}, {256, 256}, {301, 300}, {1000, 3}};
+    for (auto &shape : shapes)
+    {
+        int sizeX = shape[0], sizeY = shape[1];
+        std::string name = std::string(typeName) + " " + std::to_string(sizeX) + "x" + std::to_string(sizeY);
+        Matrix<T> source(sizeX, sizeY), destination(sizeY, sizeX);
+        for (int i = 0; i < source.getSize(); i++)
+            source.getArrayRef()[i] = (T) (generator() % 1000);
+
+        transpose(sizeX, sizeY, source.getArrayRef(), sizeY, destination.getArrayRef(), sizeX);
+        if (!checkTransposed(sizeX, sizeY, source.getArrayRef(), destination.getArrayRef()))
+            reportFailure("out-of-place transpose of " + name + " is wrong");
+
+        Matrix<T> inPlace;
+        inPlace = source;
+        inPlace.transposeInPlace();
+        if (inPlace.getSizeX() != sizeY || inPlace.getSizeY() != sizeX || !checkTransposed(sizeX, sizeY, source.getArrayRef(), inPlace.getArrayRef()))
+            reportFailure("in-place transpose of " + name + " is wrong");
+
+        Matrix<T> outOfPlace;
+        outOfPlace = source;
+        outOfPlace.transpose();
+        if (outOfPlace.getSizeX() != sizeY || !checkTransposed(sizeX, sizeY, source.getArrayRef(), outOfPlace.getArrayRef()))
+            reportFailure("Matrix::transpose of " + name + " is wrong");
+    }
+}
+
+/**
+    Every path against the definition, for float and double (SIMD tiles)
+    and int (generic tiles), on square, non-square and ragged shapes
+*/
+BENCHMARK(transposeCorrectness)
+{
+    checkShapes<float>("float");
+    checkShapes<double>("double");
+    checkShapes<int>("int");
+    reportResult("kernel." + std::string(getTransposeKernelName()), 1, "");
+}
+
+/**
+    Switching a 8192 sample x 1024 feature matrix between feature-major and
+    sample-major, against naive loops and against a plain copy of the same
+    bytes, plus a block that stays in cache. Bandwidth counts the bytes
+    read and written.
+*/
+BENCHMARK(transposeThroughput)
+{
+    const int features = 1024, samples = 8192;
+    Matrix<float> featureMatrix(features, samples), switched(samples, features);
+    for (int i = 0; i < featureMatrix.getSize(); i++)
+        featureMatrix.getArrayRef()[i] = (float) i;
+    double bytes = 2.0 * featureMatrix.getSize() * sizeof(float);
+
+    const float* source = featureMatrix.getArrayRef();
+    float* destination = switched.getArrayRef();
+    transpose(features, samples, source, samples, destination, features); // Warm up
+    BenchmarkTimer timer;
+    transpose(features, samples, source, samples, destination, features);
+    double blockedSeconds = timer.seconds();
+
+    timer.reset();
+    for (int x = 0; x < features; x++)
+        for (int y = 0; y < samples; y++)
+            destination[(long long) y * features + x] = source[(long long) x * samples + y];
+    double naiveSeconds = timer.seconds();
+
+    // Copying the same bytes is the bound of any out-of-cache transpose
+    timer.reset();
+    std::copy(source, source + featureMatrix.getSize(), destination);
+    double copySeconds = timer.seconds();
+
+    // A 256 x 256 block, which stays in cache
+    Matrix<float> block(256, 256), blockTransposed(256, 256);
+    block.fill(1);
+    const int repetitions = 1000;
+    timer.reset();
+    for (int r = 0; r < repetitions; r++)
+        transpose(256, 256, block.getArrayRef(), 256, blockTransposed.getArrayRef(), 256);
+    double inCacheSeconds = timer.seconds() / repetitions;
+
+    timer.reset();
+    featureMatrix.transpose();
+    featureMatrix.transpose();
+    double matrixSeconds = timer.seconds() / 2;
+
+    // In place on a smaller non-square matrix
+    Matrix<float> inPlace(1000, 3000);
+    for (int i = 0; i < inPlace.getSize(); i++)
+        inPlace.getArrayRef()[i] = (float) i;
+    timer.reset();
+    inPlace.transposeInPlace();
+    double inPlaceSeconds = timer.seconds();
+
+    reportResult("blocked.gbytes_per_second", bytes / blockedSeconds * 1e-9, "GB/s");
+    reportResult("naive.gbytes_per_second", bytes / naiveSeconds * 1e-9, "GB/s");
+    reportResult("copy.gbytes_per_second", bytes / copySeconds * 1e-9, "GB/s");
+    reportResult("in_cache_256x256.gbytes_per_second", 2.0 * block.getSize() * sizeof(float) / inCacheSeconds * 1e-9, "GB/s");
+    reportResult("matrix_transpose.gbytes_per_second", bytes / matrixSeconds * 1e-9, "GB/s");
+    reportResult("in_place_non_square.gbytes_per_second", 2.0 * inPlace.getSize() * sizeof(float) / inPlaceSeconds * 1e-9, "GB/s");
+    if (featureMatrix.getSizeX() != features || featureMatrix.getArrayRef()[12345] != 12345.0f)
+        reportFailure("transposing twice did not restore the matrix");
+}
@@ -2,8 +2,10 @@
 #include <random>
 #include <chrono>
 #include <vector>
+#include <cstdlib>
 
 #include "Neuron.h"
+#include "ConvergenceMonitor.h"
 
 using namespace std;
 
@@ -43,17 +45,19 @@ float perceptronTest()
 
     /* Learning phase */
     cout << "\nLearning phase:" << endl;
-    perceptron.deltaLearning(featureMatrix, classificationVector, 50, 0.5f);
-    cout << "Success." << endl;
+    ConvergenceMonitor monitor; // Stops at the first epoch without errors, at most 50
+    perceptron.deltaLearning(featureMatrix, classificationVector, 50, 0.5f, monitor);
+    cout << "Success after " << monitor.getEpochCount() << " epochs, " << monitor.getLastEpoch().errorCount << " errors in the last one." << endl;
     // perceptron.hebbianLearning(featureMatrix, 50, 0.5);
 
     /* Data classification with training data */
     cout << "\nTraining data classification phase" << endl;
+    Array<float> predictionVector(classificationVector.size());
+    perceptron.predictBatch(featureMatrix, predictionVector.getArray());
     int correct = 0;
     for (int i = 0; i < classificationVector.size(); i++)
     {
-        Matrix<float> dataPoint = featureMatrix.subMatrix(0, featureMatrix.getSizeX(), i, i);
-        if (round(perceptron.predict(dataPoint)) == classificationVector[i])
+        if (round(predictionVector[i]) == classificationVector[i])
             correct++;
     }
     cout << "Correctly classified = " << correct << ", incorrectly classified = " << classificationVector.size() - correct << endl;
@@ -63,11 +67,12 @@ float perceptronTest()
     Matrix<float> testFeatureMatrix; // Generate test data
     Array<float> testClassificationMatrix;
     dataGenerator(100, testFeatureMatrix, testClassificationMatrix);
+    Array<float> testPredictionVector(testClassificationMatrix.size());
+    perceptron.predictBatch(testFeatureMatrix, testPredictionVector.getArray());
     correct = 0;
     for (int i = 0; i < testClassificationMatrix.size(); i++)
     {
-        Matrix<float> dataPoint = testFeatureMatrix.subMatrix(0, testFeatureMatrix.getSizeX(), i, i);
-        if (round(perceptron.predict(dataPoint)) == testClassificationMatrix[i])
+        if (round(testPredictionVector[i]) == testClassificationMatrix[i])
             correct++;
     }
     cout << "Correctly classified = " << correct << ", incorrectly classified = " << testClassificationMatrix.size() - correct << endl;
@@ -77,10 +82,11 @@ float perceptronTest()
     return correct / (float) testClassificationMatrix.size() * 100; // Return the success rate
 }
 
-int main()
+int main(int argc, char* argv[])
 {
     /* Initialisation */
-    srand(time(NULL));
+    // A seed can be given to reproduce a run
+    srand(argc > 1 ? (unsigned) atoi(argv[1]) : (unsigned) time(NULL));
 
     // Testing a single neuron/perceptron
     perceptronTest();